@@ -0,0 +1,228 @@
+"""Benchmarks of the Python bindings against the monaco datasets built by tests/data/Makefile.
+
+Covers the services on the CH and MLD datasets, their scaling over threads, parameter construction
+at different sizes, and the conversion of responses into Python objects. Results are written as JSON, and can be
+compared against the results of a previous release to detect regressions:
+
+    python benchmarks/bench.py --output results.json
+    python benchmarks/bench.py --output results.json --compare baseline.json --threshold 0.10
+"""
+import argparse
+import json
+import os
+import platform
+import random
+import statistics
+import sys
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+import osrm
+
+DATA_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "tests", "data")
+
+
+def coordinates(n, seed = 42):
+    """The same pseudo-random points inside Monaco on every run."""
+    rng = random.Random(seed)
+    return [(rng.uniform(7.4130, 7.4300), rng.uniform(43.7290, 43.7420)) for _ in range(n)]
+
+
+def trace(py_osrm, n):
+    """Points along the geometry of a route, so that the trace matches."""
+    res = py_osrm.Route(osrm.RouteParameters(
+        coordinates = coordinates(4, seed = 7),
+        geometries = "geojson",
+        overview = "full"
+    ))
+    line = res["routes"][0]["geometry"]["coordinates"]
+    return [tuple(line[i * len(line) // n]) for i in range(n)]
+
+
+def measure(func, min_time, repeat):
+    """Runs func in `repeat` rounds of at least min_time seconds each, returns seconds per call per round."""
+    func()
+    number = 1
+    while True:
+        start = time.perf_counter()
+        for _ in range(number):
+            func()
+        elapsed = time.perf_counter() - start
+        if elapsed >= min_time / 10 or number >= 1 << 20:
+            break
+        number *= 2
+    number = max(1, int(number * (min_time / max(elapsed, 1e-9))))
+
+    rounds = []
+    for _ in range(repeat):
+        start = time.perf_counter()
+        for _ in range(number):
+            func()
+        rounds.append((time.perf_counter() - start) / number)
+    return rounds, number
+
+
+def service_cases(name, py_osrm):
+    """Every service on one dataset, with the default dict output."""
+    route2 = osrm.RouteParameters(coordinates = coordinates(2))
+    route10 = osrm.RouteParameters(coordinates = coordinates(10))
+    table10 = osrm.TableParameters(coordinates = coordinates(10))
+    table100 = osrm.TableParameters(coordinates = coordinates(100))
+    nearest = osrm.NearestParameters(coordinates = coordinates(1), number_of_results = 10)
+    points = trace(py_osrm, 50)
+    match = osrm.MatchParameters(coordinates = points, timestamps = [1700000000 + 5 * i for i in range(len(points))])
+    trip = osrm.TripParameters(coordinates = coordinates(10))
+    tile = osrm.TileParameters(17059, 11948, 15)
+
+    return {
+        f"{name}/route/2": lambda: py_osrm.Route(route2),
+        f"{name}/route/10": lambda: py_osrm.Route(route10),
+        f"{name}/table/10": lambda: py_osrm.Table(table10),
+        f"{name}/table/100": lambda: py_osrm.Table(table100),
+        f"{name}/nearest/10": lambda: py_osrm.Nearest(nearest),
+        f"{name}/match/50": lambda: py_osrm.Match(match),
+        f"{name}/trip/10": lambda: py_osrm.Trip(trip),
+        f"{name}/tile/15": lambda: py_osrm.Tile(tile),
+    }
+
+
+def scaling_cases(name, py_osrm, pool, threads):
+    """The same batch of routes run serially and spread over the threads of pool, their ratio is the speedup."""
+    route = osrm.RouteParameters(coordinates = coordinates(3), overview = "full", steps = True)
+    batch = 16 * threads
+
+    def serial():
+        for _ in range(batch):
+            py_osrm.Route(route)
+
+    def threaded():
+        futures = [pool.submit(lambda: [py_osrm.Route(route) for _ in range(batch // threads)]) for _ in range(threads)]
+        for f in futures:
+            f.result()
+
+    return {
+        f"{name}/scaling/route/serial": serial,
+        f"{name}/scaling/route/threads{threads}": threaded,
+    }
+
+
+def parameter_cases():
+    """Parameter construction from lists and NumPy arrays of increasing size."""
+    cases = {}
+    for n in (2, 100, 10000):
+        points = coordinates(n)
+        cases[f"params/route/list/{n}"] = lambda points = points: osrm.RouteParameters(coordinates = points)
+        cases[f"params/table/list/{n}"] = lambda points = points: osrm.TableParameters(coordinates = points)
+    try:
+        import numpy as np
+    except ImportError:
+        return cases
+    for n in (2, 100, 10000):
+        array = np.array(coordinates(n))
+        cases[f"params/route/numpy/{n}"] = lambda array = array: osrm.RouteParameters(coordinates = array)
+        cases[f"params/table/numpy/{n}"] = lambda array = array: osrm.TableParameters(coordinates = array)
+    return cases
+
+
+def conversion_cases(py_osrm):
+    """The same responses converted into every output type."""
+    route = osrm.RouteParameters(coordinates = coordinates(10), steps = True, annotations = ["all"], overview = "full")
+    table = osrm.TableParameters(coordinates = coordinates(100), annotations = ["duration", "distance"])
+    cases = {}
+    for output in ("dict", "object", "bytes"):
+        cases[f"convert/route/{output}"] = lambda output = output: py_osrm.Route(route, output = output)
+        cases[f"convert/table/{output}"] = lambda output = output: py_osrm.Table(table, output = output)
+    cases["convert/route/object_to_dict"] = lambda: py_osrm.Route(route, output = "object").to_dict()
+    try:
+        import numpy  # noqa: F401
+        cases["convert/table/numpy"] = lambda: py_osrm.Table(table, output = "numpy")
+    except ImportError:
+        pass
+    return cases
+
+
+def compare(results, baseline_path, threshold):
+    """Prints the benchmarks that got slower than the baseline by more than threshold, returns their number."""
+    with open(baseline_path) as f:
+        baseline = {b["name"]: b for b in json.load(f)["benchmarks"]}
+
+    regressions = 0
+    for bench in results:
+        before = baseline.get(bench["name"])
+        if before is None:
+            continue
+        change = bench["median_s"] / before["median_s"] - 1.0
+        marker = ""
+        if change > threshold:
+            marker = "  REGRESSION"
+            regressions += 1
+        print(f"{bench['name']:40s} {before['median_s'] * 1e6:12.1f}us -> {bench['median_s'] * 1e6:12.1f}us {change:+8.1%}{marker}")
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description = __doc__, formatter_class = argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--data", default = DATA_DIR, help = "Directory holding the ch/ and mld/ monaco datasets.")
+    parser.add_argument("--output", default = "benchmark-results.json", help = "JSON file the results are written to.")
+    parser.add_argument("--filter", default = "", help = "Only run benchmarks whose name contains this string.")
+    parser.add_argument("--min-time", type = float, default = 0.2, help = "Minimum seconds per round.")
+    parser.add_argument("--repeat", type = int, default = 5, help = "Number of rounds per benchmark.")
+    parser.add_argument("--threads", type = int, default = min(4, os.cpu_count() or 1), help = "Threads of the scaling benchmarks.")
+    parser.add_argument("--compare", help = "Results of a previous run to compare against.")
+    parser.add_argument("--threshold", type = float, default = 0.10, help = "Relative slowdown of the median reported as regression.")
+    args = parser.parse_args()
+
+    engines = {
+        "ch": osrm.OSRM(storage_config = os.path.join(args.data, "ch", "monaco.osrm"), use_shared_memory = False,
+                        max_locations_distance_table = -1, max_locations_map_matching = -1, max_locations_trip = -1),
+        "mld": osrm.OSRM(algorithm = "MLD", storage_config = os.path.join(args.data, "mld", "monaco.osrm"), use_shared_memory = False,
+                         max_locations_distance_table = -1, max_locations_map_matching = -1, max_locations_trip = -1),
+    }
+
+    pool = ThreadPoolExecutor(max_workers = args.threads)
+
+    cases = {}
+    for name, py_osrm in engines.items():
+        cases.update(service_cases(name, py_osrm))
+        cases.update(scaling_cases(name, py_osrm, pool, args.threads))
+    cases.update(parameter_cases())
+    cases.update(conversion_cases(engines["ch"]))
+
+    results = []
+    for name, func in cases.items():
+        if args.filter not in name:
+            continue
+        rounds, number = measure(func, args.min_time, args.repeat)
+        results.append({
+            "name": name,
+            "calls_per_round": number,
+            "rounds": len(rounds),
+            "median_s": statistics.median(rounds),
+            "mean_s": statistics.fmean(rounds),
+            "min_s": min(rounds),
+            "stdev_s": statistics.stdev(rounds) if len(rounds) > 1 else 0.0,
+        })
+        print(f"{name:40s} {results[-1]['median_s'] * 1e6:12.1f}us", file = sys.stderr)
+
+    pool.shutdown()
+
+    report = {
+        "meta": {
+            "timestamp": time.strftime("%Y-%m-%dT%H:%M:%SZ", time.gmtime()),
+            "python": platform.python_version(),
+            "implementation": platform.python_implementation(),
+            "platform": platform.platform(),
+            "machine": platform.machine(),
+            "processor": platform.processor(),
+        },
+        "benchmarks": results,
+    }
+    with open(args.output, "w") as f:
+        json.dump(report, f, indent = 2)
+
+    if args.compare and compare(results, args.compare, args.threshold) > 0:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
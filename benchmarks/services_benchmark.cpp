@@ -0,0 +1,255 @@
+#include "osrm/osrm.hpp"
+#include "osrm/engine_config.hpp"
+#include "osrm/status.hpp"
+#include "osrm/match_parameters.hpp"
+#include "osrm/nearest_parameters.hpp"
+#include "osrm/route_parameters.hpp"
+#include "osrm/table_parameters.hpp"
+#include "osrm/tile_parameters.hpp"
+#include "osrm/trip_parameters.hpp"
+#include "util/json_container.hpp"
+#include "util/json_renderer.hpp"
+
+#include "utility/engine_utility.h"
+#include "utility/param_key.h"
+#include "utility/result_cache.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <variant>
+#include <vector>
+
+// Service benchmarks against the monaco datasets built by tests/data/Makefile.
+// OSRM_BENCH_DATA overrides the data directory. Machine-readable results are written with
+//   osrm_benchmarks --benchmark_out=results.json --benchmark_out_format=json
+
+namespace json = osrm::util::json;
+using osrm::EngineConfig;
+using osrm::engine::api::MatchParameters;
+using osrm::engine::api::NearestParameters;
+using osrm::engine::api::RouteParameters;
+using osrm::engine::api::TableParameters;
+using osrm::engine::api::TileParameters;
+using osrm::engine::api::TripParameters;
+using osrm::util::Coordinate;
+using osrm::util::FloatLatitude;
+using osrm::util::FloatLongitude;
+
+namespace {
+
+enum class Dataset { CH, MLD };
+
+// Loads a dataset once, nullptr when its files are missing
+const osrm::OSRM* engine(Dataset dataset) {
+    auto load = [](Dataset dataset) -> std::unique_ptr<osrm::OSRM> {
+        const char* env = std::getenv("OSRM_BENCH_DATA");
+        const std::string dir = env != nullptr ? env : OSRM_NB_BENCH_DATA;
+
+        EngineConfig config;
+        config.use_shared_memory = false;
+        if(dataset == Dataset::CH) {
+            config.algorithm = EngineConfig::Algorithm::CH;
+            config.storage_config = osrm::storage::StorageConfig(dir + "/ch/monaco.osrm");
+        } else {
+            config.algorithm = EngineConfig::Algorithm::MLD;
+            config.storage_config = osrm::storage::StorageConfig(dir + "/mld/monaco.osrm");
+        }
+        config.max_locations_distance_table = -1;
+        config.max_locations_trip = -1;
+        config.max_locations_map_matching = -1;
+
+        if(!config.IsValid()) {
+            return nullptr;
+        }
+        return std::make_unique<osrm::OSRM>(config);
+    };
+
+    static const std::unique_ptr<osrm::OSRM> ch = load(Dataset::CH);
+    static const std::unique_ptr<osrm::OSRM> mld = load(Dataset::MLD);
+    return dataset == Dataset::CH ? ch.get() : mld.get();
+}
+
+// Same pseudo-random points inside Monaco on every run
+std::vector<Coordinate> coordinates(std::size_t n, unsigned seed = 42) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> lon(7.4130, 7.4300);
+    std::uniform_real_distribution<double> lat(43.7290, 43.7420);
+
+    std::vector<Coordinate> points;
+    points.reserve(n);
+    for(std::size_t i = 0; i < n; ++i) {
+        points.emplace_back(FloatLongitude{lon(rng)}, FloatLatitude{lat(rng)});
+    }
+    return points;
+}
+
+// Points along the full geometry of a route, so that the trace matches
+std::vector<Coordinate> trace(const osrm::OSRM& instance, std::size_t n) {
+    RouteParameters params;
+    params.coordinates = coordinates(4, 7);
+    params.geometries = RouteParameters::GeometriesType::GeoJSON;
+    params.overview = RouteParameters::OverviewType::Full;
+
+    json::Object result;
+    if(instance.Route(params, result) != osrm::engine::Status::Ok) {
+        return {};
+    }
+    const auto& route = std::get<json::Object>(std::get<json::Array>(result.values.at("routes")).values.at(0));
+    const auto& geometry = std::get<json::Object>(route.values.at("geometry"));
+    const auto& line = std::get<json::Array>(geometry.values.at("coordinates")).values;
+
+    std::vector<Coordinate> points;
+    for(std::size_t i = 0; i < n && !line.empty(); ++i) {
+        const auto& point = std::get<json::Array>(line[i * line.size() / n]).values;
+        points.emplace_back(FloatLongitude{std::get<json::Number>(point[0]).value},
+                            FloatLatitude{std::get<json::Number>(point[1]).value});
+    }
+    return points;
+}
+
+template<typename Parameters>
+void run(benchmark::State& state, const osrm::OSRM& instance, const Parameters& params) {
+    for(auto _ : state) {
+        json::Object result;
+        const osrm::engine::Status status = osrm_nb_util::Service<Parameters>::run(instance, params, result);
+        if(status != osrm::engine::Status::Ok) {
+            state.SkipWithError(osrm_nb_util::status_code(status, result).c_str());
+            break;
+        }
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+// Declares instance, the engine of dataset, or skips the benchmark when it is missing
+#define REQUIRE_ENGINE(dataset)                                         \
+    const osrm::OSRM* instance = engine(dataset);                       \
+    if(instance == nullptr) {                                           \
+        state.SkipWithError("dataset missing, run make in tests/data"); \
+        return;                                                         \
+    }
+
+void BM_Route(benchmark::State& state, Dataset dataset) {
+    REQUIRE_ENGINE(dataset);
+    RouteParameters params;
+    params.coordinates = coordinates(static_cast<std::size_t>(state.range(0)));
+    run(state, *instance, params);
+}
+
+void BM_Table(benchmark::State& state, Dataset dataset) {
+    REQUIRE_ENGINE(dataset);
+    TableParameters params;
+    params.coordinates = coordinates(static_cast<std::size_t>(state.range(0)));
+    run(state, *instance, params);
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+
+void BM_Nearest(benchmark::State& state, Dataset dataset) {
+    REQUIRE_ENGINE(dataset);
+    NearestParameters params;
+    params.coordinates = coordinates(1);
+    params.number_of_results = static_cast<unsigned>(state.range(0));
+    run(state, *instance, params);
+}
+
+void BM_Match(benchmark::State& state, Dataset dataset) {
+    REQUIRE_ENGINE(dataset);
+    MatchParameters params;
+    params.coordinates = trace(*instance, static_cast<std::size_t>(state.range(0)));
+    for(std::size_t i = 0; i < params.coordinates.size(); ++i) {
+        params.timestamps.push_back(static_cast<unsigned>(1700000000 + 5 * i));
+    }
+    run(state, *instance, params);
+}
+
+void BM_Trip(benchmark::State& state, Dataset dataset) {
+    REQUIRE_ENGINE(dataset);
+    TripParameters params;
+    params.coordinates = coordinates(static_cast<std::size_t>(state.range(0)));
+    run(state, *instance, params);
+}
+
+void BM_Tile(benchmark::State& state, Dataset dataset) {
+    REQUIRE_ENGINE(dataset);
+    const TileParameters params{17059, 11948, 15};
+    for(auto _ : state) {
+        std::string result;
+        if(instance->Tile(params, result) != osrm::engine::Status::Ok) {
+            state.SkipWithError("Tile failed");
+            break;
+        }
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+// Building and validating parameters, the part of the parameter constructors that is not Python
+void BM_BuildRouteParameters(benchmark::State& state) {
+    const auto points = coordinates(static_cast<std::size_t>(state.range(0)));
+    for(auto _ : state) {
+        RouteParameters params;
+        params.coordinates = points;
+        params.radiuses.assign(points.size(), 25.0);
+        benchmark::DoNotOptimize(params.IsValid());
+    }
+}
+
+void BM_CanonicalKey(benchmark::State& state) {
+    TableParameters params;
+    params.coordinates = coordinates(static_cast<std::size_t>(state.range(0)));
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(osrm_nb_util::canonical_key(params));
+    }
+}
+
+// Response conversions that do not involve Python: rendering to JSON text and sizing for the cache
+json::Object table_response(std::size_t n) {
+    json::Object result;
+    if(const osrm::OSRM* instance = engine(Dataset::CH)) {
+        TableParameters params;
+        params.coordinates = coordinates(n);
+        instance->Table(params, result);
+    }
+    return result;
+}
+
+void BM_RenderJson(benchmark::State& state) {
+    const json::Object result = table_response(static_cast<std::size_t>(state.range(0)));
+    std::size_t bytes = 0;
+    for(auto _ : state) {
+        std::string rendered;
+        json::render(rendered, result);
+        bytes += rendered.size();
+        benchmark::DoNotOptimize(rendered);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+}
+
+void BM_ApproximateSize(benchmark::State& state) {
+    const json::Object result = table_response(static_cast<std::size_t>(state.range(0)));
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(osrm_nb_util::approximate_size(result));
+    }
+}
+
+} //namespace
+
+#define SERVICE_BENCHMARK(name, ...)                                                        \
+    BENCHMARK_CAPTURE(name, ch, Dataset::CH)->Unit(benchmark::kMicrosecond)->__VA_ARGS__;   \
+    BENCHMARK_CAPTURE(name, mld, Dataset::MLD)->Unit(benchmark::kMicrosecond)->__VA_ARGS__
+
+SERVICE_BENCHMARK(BM_Route, Arg(2)->Arg(10));
+SERVICE_BENCHMARK(BM_Table, Arg(10)->Arg(100));
+SERVICE_BENCHMARK(BM_Nearest, Arg(1)->Arg(10));
+SERVICE_BENCHMARK(BM_Match, Arg(10)->Arg(50));
+SERVICE_BENCHMARK(BM_Trip, Arg(5)->Arg(10));
+SERVICE_BENCHMARK(BM_Tile, Iterations(20));
+
+BENCHMARK(BM_BuildRouteParameters)->Arg(2)->Arg(100)->Arg(10000);
+BENCHMARK(BM_CanonicalKey)->Arg(10)->Arg(1000);
+BENCHMARK(BM_RenderJson)->Arg(10)->Arg(100)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ApproximateSize)->Arg(10)->Arg(100)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,375 @@
+#ifndef OSRM_NB_OSRM_H
+#define OSRM_NB_OSRM_H
+
+#include "osrm/osrm.hpp"
+#include "osrm/engine_config.hpp"
+
+#include "utility/async_executor.h"
+#include "utility/dataset_warmup.h"
+#include "utility/feature_presets.h"
+#include "utility/hint_cache.h"
+#include "utility/result_cache.h"
+#include "utility/service_stats.h"
+#include "utility/thread_pool.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Response representations selectable through the output argument of the services
+enum class OutputType {
+    Dict,
+    Object,
+    Bytes,
+    Numpy
+};
+
+static const std::unordered_map<std::string, OutputType> output_type_map {
+    { "dict", OutputType::Dict },
+    { std::string(), OutputType::Dict },
+    { "object", OutputType::Object },
+    { "bytes", OutputType::Bytes },
+    { "numpy", OutputType::Numpy }
+};
+
+// Options of the binding itself, accepted by osrm.OSRM next to the EngineConfig keyword arguments
+struct HandleOptions {
+    std::size_t num_threads = 0;
+    std::size_t max_in_flight = 0;
+    // The result cache is enabled when either budget is set
+    std::size_t cache_max_entries = 0;
+    std::size_t cache_max_bytes = 0;
+    // The snap cache is enabled when set
+    std::size_t snap_cache_entries = 0;
+    // Pre-faults the dataset files before the constructor returns
+    bool warmup = false;
+    bool warmup_huge_pages = false;
+    bool warmup_lock = false;
+};
+
+// Resources an OSRMHandle shares with the other profiles of a Router
+struct SharedResources {
+    std::shared_ptr<osrm_nb_util::ThreadPool> pool;
+    // Null when caching is disabled
+    std::shared_ptr<osrm_nb_util::ResultCache> cache;
+    // Prepended to the cache keys of the handle, so that the profiles do not see each other's responses
+    std::string cache_prefix;
+};
+
+// Outcome of OSRMHandle::swap, in seconds
+struct SwapReport {
+    double build_seconds = 0;
+    double drain_seconds = 0;
+    double seconds = 0;
+    // False when requests still held the old engine after the drain timeout, the last of them frees it
+    bool drained = true;
+};
+
+// An engine with the settings it was built with, its snap cache, and the number of requests running on it
+struct EngineGeneration {
+    EngineGeneration(osrm::engine::EngineConfig& config, std::uint64_t number, std::size_t snap_cache_entries)
+        : engine(std::make_shared<const osrm::OSRM>(config)),
+          max_table_locations(config.max_locations_distance_table),
+          number(number)
+    {
+        if(snap_cache_entries > 0) {
+            hints = std::make_unique<osrm_nb_util::HintCache>(snap_cache_entries, 0);
+        }
+    }
+
+    std::shared_ptr<const osrm::OSRM> engine;
+    const int max_table_locations;
+    // Counts the engines of a handle. It is part of the response cache keys, so that a response of an
+    // older dataset, cached by a request that was still running on it, is never served again.
+    const std::uint64_t number;
+    // Hints only apply to the dataset they were snapped on. Null when the snap cache is disabled.
+    std::unique_ptr<osrm_nb_util::HintCache> hints;
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::size_t requests = 0;
+};
+
+// The engine a request runs on, with the cache key generation and the snap cache that belong to it
+struct EnginePin {
+    // Counts as a request running on the engine until released, and keeps the snap cache alive
+    std::shared_ptr<const osrm::OSRM> engine;
+    std::uint64_t generation = 0;
+    osrm_nb_util::HintCache* hints = nullptr;
+};
+
+// The object exposed to Python as osrm.OSRM: the engine plus the worker pool used by the batch and async services.
+// The engine is published through an atomic shared_ptr: every request pins the engine it starts on, so that
+// swap can replace it without blocking the requests, which finish on the dataset they started with. The pins
+// are counted, so that swap can wait for the requests on the old engine.
+class OSRMHandle {
+public:
+    // shared replaces the pool and response cache the handle would create from options
+    explicit OSRMHandle(osrm::engine::EngineConfig& config,
+                        const HandleOptions& options = HandleOptions(),
+                        std::optional<SharedResources> shared = std::nullopt)
+        : instance(std::make_shared<EngineGeneration>(config, 0, options.snap_cache_entries)),
+          config(config),
+          options(options)
+    {
+        if(shared) {
+            worker_pool = std::move(shared->pool);
+            result_cache = std::move(shared->cache);
+            key_prefix = std::move(shared->cache_prefix);
+        } else if(options.cache_max_entries > 0 || options.cache_max_bytes > 0) {
+            result_cache = std::make_shared<osrm_nb_util::ResultCache>(options.cache_max_entries, options.cache_max_bytes);
+        }
+    }
+
+    // The current engine, kept alive by the returned pin for the duration of a request.
+    // The request counts as running on the engine until the pin is released.
+    EnginePin pin() const {
+        std::shared_ptr<EngineGeneration> generation = std::atomic_load(&instance);
+        {
+            std::lock_guard<std::mutex> lock(generation->mutex);
+            ++generation->requests;
+        }
+        EnginePin pinned;
+        pinned.generation = generation->number;
+        pinned.hints = generation->hints.get();
+        const osrm::OSRM* current = generation->engine.get();
+        pinned.engine = std::shared_ptr<const osrm::OSRM>(current, [generation = std::move(generation)](const osrm::OSRM*) {
+            std::lock_guard<std::mutex> lock(generation->mutex);
+            if(--generation->requests == 0) {
+                generation->idle.notify_all();
+            }
+        });
+        return pinned;
+    }
+
+    // The engine of pin(), for requests that use neither cache
+    std::shared_ptr<const osrm::OSRM> engine() const { return pin().engine; }
+
+    // The current engine for a long-lived user such as a MatchSession, which keeps it alive but is
+    // not waited for by swap
+    std::shared_ptr<const osrm::OSRM> session_engine() const { return std::atomic_load(&instance)->engine; }
+
+    // Builds an engine on another dataset and publishes it, called without the GIL. storage_config and
+    // dataset_name replace those of the current config when set. The new engine starts with an empty
+    // snap cache and a new generation of response cache keys. Then waits up to drain_timeout seconds
+    // for the requests still running on the old engine, so that it is usually freed here rather than
+    // by the last of them, and drops the responses of the old dataset from the cache. Responses of
+    // requests still running after that are cached under keys that are no longer looked up. Sessions
+    // holding the old engine keep it alive, but are not waited for.
+    SwapReport swap(const std::optional<std::string>& storage_config,
+                    const std::optional<std::string>& dataset_name,
+                    bool warm,
+                    double drain_timeout)
+    {
+        using clock = std::chrono::steady_clock;
+        std::lock_guard<std::mutex> swap_lock(swap_mutex);
+        const auto start = clock::now();
+
+        osrm::engine::EngineConfig next = current_config();
+        if(storage_config) {
+            // The new dataset is loaded with the same feature datasets disabled
+            osrm_nb_util::set_disabled_features(next, *storage_config, { next.disable_feature_dataset.begin(), next.disable_feature_dataset.end() });
+        }
+        if(dataset_name) {
+            next.dataset_name = *dataset_name;
+        }
+        if(!next.IsValid()) {
+            throw std::runtime_error("Config Parameters are Invalid");
+        }
+
+        std::shared_ptr<EngineGeneration> old = std::atomic_load(&instance);
+        auto fresh = std::make_shared<EngineGeneration>(next, old->number + 1, options.snap_cache_entries);
+        if(warm) {
+            run_warmup(next.storage_config.base_path, { options.warmup_huge_pages, options.warmup_lock });
+        }
+
+        SwapReport report;
+        const auto built = clock::now();
+        report.build_seconds = std::chrono::duration<double>(built - start).count();
+
+        {
+            std::lock_guard<std::mutex> lock(config_mutex);
+            config = next;
+        }
+        std::atomic_store(&instance, std::move(fresh));
+
+        const auto deadline = built + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(drain_timeout));
+        {
+            std::unique_lock<std::mutex> lock(old->mutex);
+            report.drained = old->idle.wait_until(lock, deadline, [&old] { return old->requests == 0; });
+        }
+        // The responses of the old dataset can no longer be hit, this only frees their memory
+        if(result_cache) {
+            const std::string current = cache_prefix(old->number + 1);
+            result_cache->erase_if([this, &current](const std::string& key) {
+                return key.compare(0, key_prefix.size(), key_prefix) == 0 && key.compare(0, current.size(), current) != 0;
+            });
+        }
+        old.reset();
+
+        const auto end = clock::now();
+        report.drain_seconds = std::chrono::duration<double>(end - built).count();
+        report.seconds = std::chrono::duration<double>(end - start).count();
+        request_stats.swaps().record(osrm_nb_util::ScopedTimer::elapsed_ns(start));
+        return report;
+    }
+
+    // max_locations_distance_table of the engine, <= 0 when unlimited
+    int max_locations_distance_table() const { return std::atomic_load(&instance)->max_table_locations; }
+
+    // nullptr when caching is disabled
+    osrm_nb_util::ResultCache* cache() { return result_cache.get(); }
+
+    // Prefix of the cache keys of requests on the given engine generation: the prefix of this handle,
+    // empty unless the cache is shared, followed by the generation
+    std::string cache_prefix(std::uint64_t generation) const {
+        std::string prefix = key_prefix;
+        prefix.append(reinterpret_cast<const char*>(&generation), sizeof(generation));
+        return prefix;
+    }
+
+    // Entries and bytes of the cache held by this handle
+    osrm_nb_util::ResultCache::Stats cache_stats() const {
+        if(!result_cache) {
+            return {};
+        }
+        if(key_prefix.empty()) {
+            return result_cache->stats();
+        }
+        return result_cache->stats_if([this](const std::string& key) { return key.compare(0, key_prefix.size(), key_prefix) == 0; });
+    }
+
+    // Drops the cached responses of this handle
+    void clear_cache() {
+        if(result_cache && key_prefix.empty()) {
+            result_cache->clear();
+        } else if(result_cache) {
+            result_cache->erase_if([this](const std::string& key) { return key.compare(0, key_prefix.size(), key_prefix) == 0; });
+        }
+    }
+
+    // Size of the dataset files, 0 for shared memory
+    std::uint64_t dataset_bytes() {
+        return osrm_nb_util::dataset_bytes(current_config().storage_config.base_path);
+    }
+
+    // Snap cache of the current engine, null when the snap cache is disabled
+    std::shared_ptr<osrm_nb_util::HintCache> hint_cache() const {
+        std::shared_ptr<EngineGeneration> generation = std::atomic_load(&instance);
+        osrm_nb_util::HintCache* hints = generation->hints.get();
+        return std::shared_ptr<osrm_nb_util::HintCache>(std::move(generation), hints);
+    }
+
+    // Per-service request counters and phase histograms
+    osrm_nb_util::StatsRegistry& stats() { return request_stats; }
+
+    // Pre-faults the dataset files on the worker pool, called without the GIL
+    osrm_nb_util::WarmupReport warmup(const osrm_nb_util::WarmupOptions& warmup_options) {
+        return run_warmup(current_config().storage_config.base_path, warmup_options);
+    }
+
+    // Report of the latest warm-up, empty when none ran
+    std::optional<osrm_nb_util::WarmupReport> last_warmup() {
+        std::lock_guard<std::mutex> lock(warmup_mutex);
+        return last_report;
+    }
+
+    // The pool is only spawned once a batch service is used
+    osrm_nb_util::ThreadPool& pool() {
+        std::call_once(pool_flag, [this] {
+            if(!worker_pool) {
+                worker_pool = std::make_shared<osrm_nb_util::ThreadPool>(options.num_threads);
+            }
+        });
+        return *worker_pool;
+    }
+
+    // Created on the first async request, possibly from several threads at once without the GIL
+    osrm_nb_util::AsyncExecutor& executor() {
+        std::call_once(executor_flag, [this] {
+            async_executor = std::make_unique<osrm_nb_util::AsyncExecutor>(pool(), options.max_in_flight);
+        });
+        return *async_executor;
+    }
+
+private:
+    osrm::engine::EngineConfig current_config() {
+        std::lock_guard<std::mutex> lock(config_mutex);
+        return config;
+    }
+
+    osrm_nb_util::WarmupReport run_warmup(const std::filesystem::path& base_path, const osrm_nb_util::WarmupOptions& warmup_options) {
+        osrm_nb_util::WarmupReport report = dataset_warmup.run(base_path, pool(), warmup_options);
+        std::lock_guard<std::mutex> lock(warmup_mutex);
+        last_report = report;
+        return report;
+    }
+
+    // Only accessed through std::atomic_load / std::atomic_store
+    std::shared_ptr<EngineGeneration> instance;
+    std::mutex config_mutex;
+    osrm::engine::EngineConfig config;
+    std::mutex swap_mutex;
+    HandleOptions options;
+    std::string key_prefix;
+    std::shared_ptr<osrm_nb_util::ResultCache> result_cache;
+    osrm_nb_util::StatsRegistry request_stats;
+    osrm_nb_util::DatasetWarmup dataset_warmup;
+    std::mutex warmup_mutex;
+    std::optional<osrm_nb_util::WarmupReport> last_report;
+    std::once_flag pool_flag;
+    std::shared_ptr<osrm_nb_util::ThreadPool> worker_pool;
+    std::once_flag executor_flag;
+    // Declared last, so that it is destroyed before the pool and the engine it uses
+    std::unique_ptr<osrm_nb_util::AsyncExecutor> async_executor;
+};
+
+// The object exposed to Python as osrm.Router: several named datasets, typically one per profile, behind one object.
+// Every profile is a full OSRMHandle, but they share one worker pool and one response cache budget.
+class Router {
+public:
+    Router(std::vector<std::pair<std::string, osrm::engine::EngineConfig>>& configs, const HandleOptions& options)
+        : shared_pool(std::make_shared<osrm_nb_util::ThreadPool>(options.num_threads))
+    {
+        if(options.cache_max_entries > 0 || options.cache_max_bytes > 0) {
+            shared_cache = std::make_shared<osrm_nb_util::ResultCache>(options.cache_max_entries, options.cache_max_bytes);
+        }
+        for(auto& [name, config] : configs) {
+            // The terminator keeps a profile name from being the prefix of another
+            SharedResources shared{ shared_pool, shared_cache, name + '\0' };
+            profiles.emplace(name, std::make_unique<OSRMHandle>(config, options, std::move(shared)));
+        }
+    }
+
+    // nullptr for an unknown profile
+    OSRMHandle* profile(const std::string& name) {
+        auto itr = profiles.find(name);
+        return itr == profiles.end() ? nullptr : itr->second.get();
+    }
+
+    // Profile names in sorted order
+    std::vector<std::string> names() const {
+        std::vector<std::string> out;
+        for(const auto& entry : profiles) {
+            out.push_back(entry.first);
+        }
+        return out;
+    }
+
+private:
+    std::shared_ptr<osrm_nb_util::ThreadPool> shared_pool;
+    std::shared_ptr<osrm_nb_util::ResultCache> shared_cache;
+    std::map<std::string, std::unique_ptr<OSRMHandle>> profiles;
+};
+
+#endif //OSRM_NB_OSRM_H
@@ -2,9 +2,11 @@
 #define OSRM_NB_BASEPARAMETER_H
 
 #include "engine/api/base_parameters.hpp"
+#include "utility/param_key.h"
 
 #include <nanobind/nanobind.h>
 
+#include <string>
 #include <unordered_map>
 
 using osrm::engine::api::BaseParameters;
@@ -23,4 +25,23 @@ static const std::unordered_map<std::string, BaseParameters::OutputFormatType> o
     { "flatbuffers", BaseParameters::OutputFormatType::FLATBUFFERS }
 };
 
+// __eq__ of the parameter classes: compares the canonical keys of two objects of exactly the same Python type,
+// so that a RouteParameters never equals a MatchParameters through their common base
+template<typename Parameters>
+nanobind::object params_equal(nanobind::handle self, nanobind::handle other) {
+    if(!self.type().is(other.type())) {
+        return nanobind::borrow(Py_NotImplemented);
+    }
+    return nanobind::bool_(osrm_nb_util::canonical_key(nanobind::cast<const Parameters&>(self)) ==
+                           osrm_nb_util::canonical_key(nanobind::cast<const Parameters&>(other)));
+}
+
+// cache_key() of the parameter classes: an immutable snapshot of the canonical key, usable as a dict key.
+// The objects themselves are mutable, and so left unhashable.
+template<typename Parameters>
+nanobind::bytes params_cache_key(const Parameters& params) {
+    const std::string key = osrm_nb_util::canonical_key(params);
+    return nanobind::bytes(key.data(), key.size());
+}
+
 #endif //OSRM_NB_BASEPARAMETER_H
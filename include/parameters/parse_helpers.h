@@ -45,6 +45,12 @@ inline osrm::engine::api::BaseParameters::SnappingType parse_snapping(const std:
     if(ls=="any") return osrm::engine::api::BaseParameters::SnappingType::Any;
     throw std::runtime_error("Invalid snapping string: "+s);
 }
+inline osrm::engine::api::BaseParameters::OutputFormatType parse_output_format(const std::string& s){
+    auto ls = to_lower(s);
+    if(ls=="json"||ls.empty()) return osrm::engine::api::BaseParameters::OutputFormatType::JSON;
+    if(ls=="flatbuffers") return osrm::engine::api::BaseParameters::OutputFormatType::FLATBUFFERS;
+    throw std::runtime_error("Invalid format string: "+s);
+}
 // Match
 inline osrm::engine::api::MatchParameters::GapsType parse_gaps(const std::string& s){
     auto ls = to_lower(s);
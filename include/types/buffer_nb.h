@@ -0,0 +1,27 @@
+#ifndef OSRM_NB_BUFFER_H
+#define OSRM_NB_BUFFER_H
+
+#include <flatbuffers/flatbuffers.h>
+
+#include <nanobind/nanobind.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+void init_Buffer(nanobind::module_& m);
+
+// Read-only bytes handed to Python through the buffer protocol. The buffer owns the
+// memory it points into, so responses are exposed without being copied.
+struct Buffer {
+    static Buffer from_string(std::string&& str);
+    static Buffer from_flatbuffer(flatbuffers::FlatBufferBuilder&& builder);
+    // Shares a finished buffer, such as one held by the result cache
+    static Buffer from_flatbuffer(std::shared_ptr<const flatbuffers::DetachedBuffer> owned);
+
+    std::shared_ptr<const void> owner;
+    const char* data = nullptr;
+    std::size_t size = 0;
+};
+
+#endif //OSRM_NB_BUFFER_H
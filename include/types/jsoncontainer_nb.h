@@ -61,6 +61,13 @@ struct ToPythonVisitor {
 };
 
 inline nb::object json_value_to_py(const json::Value &v) { return std::visit(ToPythonVisitor{}, v); }
+
+// Converts scalars right away, but returns Objects and Arrays as proxies into the tree held by owner
+inline nb::object json_value_to_lazy_py(const json::Value &v, nb::handle owner) {
+    if (auto *obj = std::get_if<json::Object>(&v)) return nb::cast(obj, nb::rv_policy::reference_internal, owner);
+    if (auto *arr = std::get_if<json::Array>(&v)) return nb::cast(arr, nb::rv_policy::reference_internal, owner);
+    return std::visit(ToPythonVisitor{}, v);
+}
 inline nb::dict json_object_to_py(const json::Object &o) {
     ToPythonVisitor vis; return nb::cast<nb::dict>(vis(o)); }
 
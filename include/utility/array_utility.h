@@ -0,0 +1,153 @@
+#ifndef OSRM_NB_ARRAY_UTIL_H
+#define OSRM_NB_ARRAY_UTIL_H
+
+#include "engine/hint.hpp"
+#include "osrm/table_parameters.hpp"
+#include "util/json_container.hpp"
+
+#include <nanobind/nanobind.h>
+#include <nanobind/ndarray.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osrm_nb_util {
+
+// Hands a vector over to NumPy without copying, the returned array owns the buffer
+template<typename T>
+nanobind::ndarray<nanobind::numpy, T> to_ndarray(std::vector<T>&& data, std::initializer_list<std::size_t> shape) {
+    auto* owned = new std::vector<T>(std::move(data));
+    nanobind::capsule owner(owned, [](void* p) noexcept {
+        delete static_cast<std::vector<T>*>(p);
+    });
+
+    return nanobind::ndarray<nanobind::numpy, T>(owned->data(), shape, owner);
+}
+
+// Same as to_ndarray, exposing a vector of 0/1 bytes as a boolean array
+nanobind::ndarray<nanobind::numpy, bool> to_bool_ndarray(std::vector<std::uint8_t>&& data, std::initializer_list<std::size_t> shape);
+
+// Row-major matrices extracted from a Table response, unreachable cells are NaN
+struct TableArrays {
+    std::size_t rows = 0;
+    std::size_t cols = 0;
+    bool has_durations = false;
+    bool has_distances = false;
+    std::vector<double> durations;
+    std::vector<double> distances;
+    std::vector<std::uint8_t> fallback_speed_cells;
+};
+
+// Pure C++, safe to call without the GIL
+TableArrays table_to_arrays(const osrm::util::json::Object& result);
+
+// Writes the matrices of a Table response into the block of arrays starting at (row, col),
+// arrays has to be allocated already. Safe to call without the GIL and for disjoint blocks concurrently.
+void copy_table_block(const osrm::util::json::Object& result, TableArrays& arrays, std::size_t row, std::size_t col);
+
+// Side length of the sub-Tables a large Table is split into: block_size, or a default when 0,
+// bounded by max_locations (max_locations_distance_table, <= 0 for unlimited) and at least 1
+std::size_t table_block_size(std::size_t block_size, int max_locations);
+
+bool has_annotation(osrm::engine::api::TableParameters::AnnotationsType annotations,
+                    osrm::engine::api::TableParameters::AnnotationsType flag);
+
+// Appends coordinate i of params, with its per-coordinate options, to table. The hint is taken
+// from hints, which is either empty or indexed like params.coordinates.
+void append_coordinate(osrm::engine::api::TableParameters& table,
+                       const osrm::engine::api::TableParameters& params,
+                       const std::vector<std::optional<osrm::engine::Hint>>& hints,
+                       std::size_t i);
+
+// Builds {"code", "durations", "distances", "fallback_speed_cells", "sources", "destinations"},
+// where the waypoints are returned column-wise
+nanobind::dict table_arrays_to_py(TableArrays&& arrays, const osrm::util::json::Object& result);
+
+// Columns of one route of a Route response, or one matching of a Match response. The annotation
+// columns are per geometry segment and concatenated over the legs, leg k covering the segments
+// leg_offsets[k]:leg_offsets[k + 1] and the points leg_offsets[k]:leg_offsets[k + 1] + 1 of the geometry.
+// Nodes repeat at leg boundaries, the nodes of leg k are nodes[node_offsets[k]:node_offsets[k + 1]].
+struct RouteArrays {
+    double duration = 0;
+    double distance = 0;
+    double weight = 0;
+    double confidence = 0; // NaN for routes
+    std::vector<double> geometry; // (N, 2) longitude, latitude
+    std::vector<std::int64_t> leg_offsets; // legs + 1 entries
+    std::vector<std::int64_t> node_offsets;
+    std::vector<std::pair<std::string, std::vector<double>>> annotations;
+    bool has_nodes = false;
+    std::vector<std::uint64_t> nodes;
+};
+
+// Extracts the routes, or matchings, of a response requested with the full GeoJSON overview and
+// at least one annotation. The distance annotation is dropped unless keep_distance, as it may
+// only have been requested to find the leg boundaries. Pure C++, safe to call without the GIL.
+std::vector<RouteArrays> route_to_arrays(const osrm::util::json::Object& result, bool keep_distance);
+
+// Builds {"code", "routes", "waypoints"}, or {"code", "matchings", "tracepoints"} for Match,
+// where every route is a dict of arrays and the waypoints are returned column-wise
+nanobind::dict route_arrays_to_py(std::vector<RouteArrays>&& routes, const osrm::util::json::Object& result);
+
+// Outcome of one point of a bulk Nearest, in the order of nearest_status_names
+enum class NearestStatus : std::uint8_t {
+    Ok,
+    NoSegment,
+    InvalidValue,
+    InvalidOptions,
+    Error
+};
+
+// Row-major (size, k) columns of a bulk Nearest, slots without a result are NaN / -1 / 0
+struct NearestArrays {
+    std::size_t size = 0;
+    std::size_t k = 1;
+    std::vector<double> lon;
+    std::vector<double> lat;
+    std::vector<double> distance;
+    std::vector<std::int32_t> name; // index into names
+    std::vector<std::uint64_t> nodes; // (size, k, 2)
+    std::vector<std::uint8_t> status; // NearestStatus per point
+    std::vector<std::string> names;
+};
+
+// Solutions of many Trip requests, the permutation of trip k is permutation[offsets[k]:offsets[k + 1]]
+struct TripArrays {
+    std::size_t size = 0;
+    std::vector<std::int64_t> offsets; // size + 1 entries
+    std::vector<std::int64_t> permutation; // input indices in visiting order, -1 for a failed request
+    std::vector<double> duration; // NaN for a failed request
+    std::vector<double> distance;
+    std::vector<std::uint32_t> num_trips; // > 1 when the coordinates span disconnected components
+};
+
+// Durations and distances of selected (source, destination) pairs, one entry per pair, NaN when unreachable
+struct PairArrays {
+    std::size_t size = 0;
+    bool has_durations = false;
+    bool has_distances = false;
+    std::vector<double> durations;
+    std::vector<double> distances;
+    std::vector<std::uint8_t> fallback_speed_cells;
+    // Number of Table requests the pairs were grouped into
+    std::size_t sub_tables = 0;
+};
+
+// Builds {"offsets", "permutation", "duration", "distance", "num_trips"}
+nanobind::dict trip_arrays_to_py(TripArrays&& arrays);
+
+// Builds {"lon", "lat", "distance", "name", "nodes", "status", "names", "status_names"},
+// dropping the k dimension when k is 1
+nanobind::dict nearest_arrays_to_py(NearestArrays&& arrays);
+
+// Builds {"code", "durations", "distances", "fallback_speed_cells", "sub_tables"}, the columns shaped (size,)
+nanobind::dict pair_arrays_to_py(PairArrays&& arrays);
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_ARRAY_UTIL_H
@@ -0,0 +1,82 @@
+#ifndef OSRM_NB_ASYNC_EXECUTOR_H
+#define OSRM_NB_ASYNC_EXECUTOR_H
+
+#include "utility/thread_pool.h"
+
+#include <nanobind/nanobind.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace osrm_nb_util {
+
+// Completes asyncio futures from the worker pool.
+//
+// Work runs on the pool without the GIL and hands back a finisher, which converts its
+// result into a Python object on the event loop thread. Finished requests are queued and
+// the loop is woken up once per batch through an eventfd (a pipe on other POSIX systems),
+// so no Python thread is needed per request. At most max_in_flight requests occupy the
+// pool at a time, the rest wait in submission order.
+class AsyncExecutor {
+public:
+    using Finisher = std::function<nanobind::object()>;
+    using Work = std::function<Finisher()>;
+
+    // A max_in_flight of 0 uses the size of the pool
+    AsyncExecutor(ThreadPool& pool, std::size_t max_in_flight = 0);
+    ~AsyncExecutor();
+
+    AsyncExecutor(const AsyncExecutor&) = delete;
+    AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+
+    // Needs an attached thread state and a running event loop. Returns an asyncio.Future resolved with the
+    // finisher's result, owner is kept alive until every pending future is resolved.
+    nanobind::object submit(nanobind::handle owner, Work work);
+
+    std::size_t max_in_flight() const { return limit; }
+
+private:
+    struct Completion {
+        std::uint64_t ticket;
+        Finisher finish;
+    };
+
+    void start(std::uint64_t ticket, Work work);
+    void complete(std::uint64_t ticket, Finisher finish);
+    void notify();
+    void drain();
+    void clear_wakeup();
+
+    ThreadPool& pool;
+    std::size_t limit;
+
+    // Guarded by mutex, shared with the workers
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::size_t running = 0;
+    std::size_t active_tasks = 0;
+    std::deque<std::pair<std::uint64_t, Work>> waiting;
+    std::vector<Completion> completed;
+
+    // Guarded by py_mutex and only touched by threads attached to the interpreter. The GIL
+    // already serializes them unless the interpreter is free-threaded.
+    nanobind::ft_mutex py_mutex;
+    std::uint64_t next_ticket = 0;
+    std::unordered_map<std::uint64_t, nanobind::object> futures;
+    nanobind::object loop;
+    nanobind::object drain_callback;
+
+    int read_fd = -1;
+    int write_fd = -1;
+};
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_ASYNC_EXECUTOR_H
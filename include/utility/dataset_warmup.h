@@ -0,0 +1,65 @@
+#ifndef OSRM_NB_DATASET_WARMUP_H
+#define OSRM_NB_DATASET_WARMUP_H
+
+#include "utility/thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+namespace osrm_nb_util {
+
+struct WarmupOptions {
+    // Asks for transparent huge pages on the mappings, Linux only
+    bool huge_pages = false;
+    // Locks the files into memory until the next warm-up or the destruction of the DatasetWarmup
+    bool lock = false;
+};
+
+struct WarmupReport {
+    std::uint64_t bytes = 0;
+    std::size_t files = 0;
+    double seconds = 0;
+    // Whether every mapping accepted MADV_HUGEPAGE / mlock, false when not requested
+    bool huge_pages = false;
+    bool locked = false;
+};
+
+// Total size of the files of the dataset at base_path that the engine loads, 0 for a shared memory dataset
+std::uint64_t dataset_bytes(const std::filesystem::path& base_path);
+
+// Pre-faults the files of a dataset, so that the first queries of an engine using them through
+// mmap do not wait on disk reads. The files are mapped separately from the engine and read one
+// byte per page in parallel, which pulls them into the page cache the engine's mapping shares.
+// Without mmap support the files are read sequentially into a scratch buffer instead.
+class DatasetWarmup {
+public:
+    DatasetWarmup() = default;
+    ~DatasetWarmup();
+
+    DatasetWarmup(const DatasetWarmup&) = delete;
+    DatasetWarmup& operator=(const DatasetWarmup&) = delete;
+
+    // Warms the files of the dataset at base_path (the storage_config path without ".osrm")
+    // that the engine loads, skipping the missing ones. Replaces the mappings locked by a
+    // previous run. Safe to call from several threads, runs are serialized.
+    WarmupReport run(const std::filesystem::path& base_path, ThreadPool& pool, const WarmupOptions& options);
+
+private:
+    struct Mapping {
+        void* data;
+        std::size_t size;
+    };
+
+    void release();
+
+    std::mutex mutex;
+    // Mappings kept alive to hold their mlock
+    std::vector<Mapping> locked;
+};
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_DATASET_WARMUP_H
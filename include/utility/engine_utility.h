@@ -0,0 +1,185 @@
+#ifndef OSRM_NB_ENGINE_UTIL_H
+#define OSRM_NB_ENGINE_UTIL_H
+
+#include "osrm/osrm.hpp"
+#include "osrm/status.hpp"
+#include "osrm/match_parameters.hpp"
+#include "osrm/nearest_parameters.hpp"
+#include "osrm/route_parameters.hpp"
+#include "osrm/table_parameters.hpp"
+#include "osrm/trip_parameters.hpp"
+#include "engine/api/base_result.hpp"
+#include "util/json_container.hpp"
+
+#include <flatbuffers/flatbuffers.h>
+
+#include "utility/hint_cache.h"
+#include "utility/service_stats.h"
+#include "utility/thread_pool.h"
+
+#include <exception>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace osrm_nb_util {
+
+// Maps a parameter type onto the engine service consuming it. cache_tag separates the
+// services in the result cache, Match traces rarely repeat and are never cached.
+// uses_hint_cache marks the services whose coordinates are snapped through the hint cache,
+// stats_service the counters its requests are recorded into.
+template<typename Parameters>
+struct Service;
+
+template<>
+struct Service<osrm::engine::api::MatchParameters> {
+    static constexpr const char* invalid_message = "Invalid Match Parameters";
+    static constexpr StatsService stats_service = StatsService::Match;
+    static constexpr bool cacheable = false;
+    static constexpr char cache_tag = 'M';
+    static constexpr bool uses_hint_cache = false;
+    static osrm::engine::Status run(const osrm::OSRM& engine, const osrm::engine::api::MatchParameters& params, osrm::util::json::Object& result) {
+        return engine.Match(params, result);
+    }
+    static osrm::engine::Status run(const osrm::OSRM& engine, const osrm::engine::api::MatchParameters& params, osrm::engine::api::ResultT& result) {
+        return engine.Match(params, result);
+    }
+};
+
+template<>
+struct Service<osrm::engine::api::NearestParameters> {
+    static constexpr const char* invalid_message = "Invalid Nearest Parameters";
+    static constexpr StatsService stats_service = StatsService::Nearest;
+    static constexpr bool cacheable = true;
+    static constexpr char cache_tag = 'N';
+    static constexpr bool uses_hint_cache = false;
+    static osrm::engine::Status run(const osrm::OSRM& engine, const osrm::engine::api::NearestParameters& params, osrm::util::json::Object& result) {
+        return engine.Nearest(params, result);
+    }
+    static osrm::engine::Status run(const osrm::OSRM& engine, const osrm::engine::api::NearestParameters& params, osrm::engine::api::ResultT& result) {
+        return engine.Nearest(params, result);
+    }
+};
+
+template<>
+struct Service<osrm::engine::api::RouteParameters> {
+    static constexpr const char* invalid_message = "Invalid Route Parameters";
+    static constexpr StatsService stats_service = StatsService::Route;
+    static constexpr bool cacheable = true;
+    static constexpr char cache_tag = 'R';
+    static constexpr bool uses_hint_cache = true;
+    static osrm::engine::Status run(const osrm::OSRM& engine, const osrm::engine::api::RouteParameters& params, osrm::util::json::Object& result) {
+        return engine.Route(params, result);
+    }
+    static osrm::engine::Status run(const osrm::OSRM& engine, const osrm::engine::api::RouteParameters& params, osrm::engine::api::ResultT& result) {
+        return engine.Route(params, result);
+    }
+};
+
+template<>
+struct Service<osrm::engine::api::TableParameters> {
+    static constexpr const char* invalid_message = "Invalid Table Parameters";
+    static constexpr StatsService stats_service = StatsService::Table;
+    static constexpr bool cacheable = true;
+    static constexpr char cache_tag = 'T';
+    static constexpr bool uses_hint_cache = true;
+    static osrm::engine::Status run(const osrm::OSRM& engine, const osrm::engine::api::TableParameters& params, osrm::util::json::Object& result) {
+        return engine.Table(params, result);
+    }
+    static osrm::engine::Status run(const osrm::OSRM& engine, const osrm::engine::api::TableParameters& params, osrm::engine::api::ResultT& result) {
+        return engine.Table(params, result);
+    }
+};
+
+template<>
+struct Service<osrm::engine::api::TripParameters> {
+    static constexpr const char* invalid_message = "Invalid Trip Parameters";
+    static constexpr StatsService stats_service = StatsService::Trip;
+    static constexpr bool cacheable = true;
+    static constexpr char cache_tag = 'P';
+    static constexpr bool uses_hint_cache = true;
+    static osrm::engine::Status run(const osrm::OSRM& engine, const osrm::engine::api::TripParameters& params, osrm::util::json::Object& result) {
+        return engine.Trip(params, result);
+    }
+    static osrm::engine::Status run(const osrm::OSRM& engine, const osrm::engine::api::TripParameters& params, osrm::engine::api::ResultT& result) {
+        return engine.Trip(params, result);
+    }
+};
+
+// "Ok" for successful requests, otherwise the error code reported in the response
+std::string status_code(osrm::engine::Status status, const osrm::util::json::Object& result);
+std::string status_code(osrm::engine::Status status, const flatbuffers::FlatBufferBuilder& result);
+
+// Builds the error response for a request whose parameters failed IsValid()
+osrm::util::json::Object invalid_options_response(const std::string& message);
+
+// Runs a request with its unset hints filled from hints, when given, and stores the hints of
+// the newly snapped coordinates of a successful response. params may get its hints filled.
+// Result is a json::Object, or a ResultT holding a FlatBufferBuilder for the flatbuffers format.
+template<typename Parameters, typename Result>
+osrm::engine::Status run_with_hints(const osrm::OSRM& engine,
+                                    Parameters& params,
+                                    Result& result,
+                                    HintCache* hints)
+{
+    if constexpr(Service<Parameters>::uses_hint_cache) {
+        if(hints != nullptr) {
+            const std::vector<bool> pending = fill_hints(params, *hints);
+            const osrm::engine::Status status = Service<Parameters>::run(engine, params, result);
+            if(status == osrm::engine::Status::Ok) {
+                if constexpr(std::is_same_v<Result, osrm::engine::api::ResultT>) {
+                    harvest_hints(params, std::get<flatbuffers::FlatBufferBuilder>(result), pending, *hints);
+                } else {
+                    harvest_hints(params, result, pending, *hints);
+                }
+            }
+            return status;
+        }
+    }
+    return Service<Parameters>::run(engine, params, result);
+}
+
+// Runs every request on the pool without throwing: a failed request leaves its error
+// response in results and its error code in codes, "Error" when the engine threw.
+// Must be called without the GIL.
+template<typename Parameters>
+void run_batch(const osrm::OSRM& engine,
+               ThreadPool& pool,
+               const std::vector<Parameters>& params,
+               std::vector<osrm::util::json::Object>& results,
+               std::vector<std::string>& codes,
+               HintCache* hints = nullptr)
+{
+    results.resize(params.size());
+    codes.resize(params.size());
+
+    pool.parallel_for(params.size(), [&](std::size_t i) {
+        if(!params[i].IsValid()) {
+            results[i] = invalid_options_response(Service<Parameters>::invalid_message);
+            codes[i] = "InvalidOptions";
+            return;
+        }
+
+        try {
+            osrm::engine::Status status;
+            if(hints != nullptr && Service<Parameters>::uses_hint_cache) {
+                Parameters request = params[i];
+                status = run_with_hints(engine, request, results[i], hints);
+            }
+            else {
+                status = Service<Parameters>::run(engine, params[i], results[i]);
+            }
+            codes[i] = status_code(status, results[i]);
+        }
+        catch(const std::exception& e) {
+            results[i] = invalid_options_response(e.what());
+            results[i].values["code"] = osrm::util::json::String("Error");
+            codes[i] = "Error";
+        }
+    });
+}
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_ENGINE_UTIL_H
@@ -0,0 +1,56 @@
+#ifndef OSRM_NB_FEATURE_PRESETS_H
+#define OSRM_NB_FEATURE_PRESETS_H
+
+#include "osrm/engine_config.hpp"
+#include "storage/storage_config.hpp"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace osrm_nb_util {
+
+using FeatureDatasets = std::vector<osrm::storage::FeatureDataset>;
+
+static const std::unordered_map<std::string, osrm::storage::FeatureDataset> feature_dataset_map {
+    { "ROUTE_STEPS", osrm::storage::FeatureDataset::ROUTE_STEPS },
+    { "ROUTE_GEOMETRY", osrm::storage::FeatureDataset::ROUTE_GEOMETRY }
+};
+
+// Feature datasets left out by each preset. Nearest keeps the geometry, which holds the OSM node ids
+// of its response. Requests needing a dataset that is not loaded fail with a DisabledDataset error.
+static const std::unordered_map<std::string, FeatureDatasets> feature_preset_map {
+    { "full", {} },
+    { "table_only", { osrm::storage::FeatureDataset::ROUTE_STEPS, osrm::storage::FeatureDataset::ROUTE_GEOMETRY } },
+    { "nearest_only", { osrm::storage::FeatureDataset::ROUTE_STEPS } }
+};
+
+std::string feature_dataset_name(osrm::storage::FeatureDataset dataset);
+
+// Points config at the dataset at storage_path, loaded without the disabled feature datasets
+void set_disabled_features(osrm::engine::EngineConfig& config, const std::string& storage_path, const FeatureDatasets& disabled);
+
+// Resident set size of the process, 0 where it can not be read
+std::uint64_t resident_bytes();
+
+struct PresetReport {
+    std::string preset;
+    FeatureDatasets disabled;
+    // Growth of the resident set while the engine was built, and its difference to the full preset
+    std::uint64_t resident_bytes = 0;
+    std::int64_t saved_bytes = 0;
+    double load_seconds = 0;
+};
+
+// Builds an engine on the dataset at storage_path for the full preset and each of presets in turn,
+// measuring how much each one adds to the resident set. The engines are loaded into process memory
+// rather than through mmap, so that the whole of their data is resident. Only one engine exists at
+// a time, but the process needs room for the full dataset.
+std::vector<PresetReport> compare_feature_presets(osrm::engine::EngineConfig config,
+                                                  const std::string& storage_path,
+                                                  const std::vector<std::string>& presets);
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_FEATURE_PRESETS_H
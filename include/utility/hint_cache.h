@@ -0,0 +1,79 @@
+#ifndef OSRM_NB_HINT_CACHE_H
+#define OSRM_NB_HINT_CACHE_H
+
+#include "osrm/route_parameters.hpp"
+#include "osrm/table_parameters.hpp"
+#include "osrm/trip_parameters.hpp"
+#include "engine/api/base_parameters.hpp"
+#include "engine/hint.hpp"
+#include "util/json_container.hpp"
+
+#include <flatbuffers/flatbuffers.h>
+
+#include "utility/lru_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace osrm_nb_util {
+
+// Everything that decides where a coordinate snaps to: the fixed-point coordinate itself,
+// its radius and bearing, and the request-wide snapping and exclude classes
+struct SnapKey {
+    std::int32_t lon = 0;
+    std::int32_t lat = 0;
+    std::uint8_t snapping = 0;
+    bool has_radius = false;
+    double radius = 0;
+    bool has_bearing = false;
+    short bearing = 0;
+    short range = 0;
+    std::uint64_t exclude = 0;
+
+    bool operator==(const SnapKey& other) const;
+};
+
+struct SnapKeyHash {
+    std::size_t operator()(const SnapKey& key) const;
+};
+
+// Hints of previously snapped coordinates, so that repeated coordinates skip the R-tree lookup
+using HintCache = ShardedLruCache<SnapKey, osrm::engine::Hint, SnapKeyHash>;
+
+// Fills every hint the caller left unset from cache. Returns a flag per coordinate whose
+// hint is still missing, empty when none is.
+std::vector<bool> fill_hints(osrm::engine::api::BaseParameters& params, HintCache& cache);
+
+// Stores the hints of the snapped waypoints in a successful response for the coordinates
+// flagged by fill_hints. Responses without hints (generate_hints = false) are skipped.
+void harvest_hints(const osrm::engine::api::RouteParameters& params,
+                   const osrm::util::json::Object& result,
+                   const std::vector<bool>& pending,
+                   HintCache& cache);
+void harvest_hints(const osrm::engine::api::TableParameters& params,
+                   const osrm::util::json::Object& result,
+                   const std::vector<bool>& pending,
+                   HintCache& cache);
+void harvest_hints(const osrm::engine::api::TripParameters& params,
+                   const osrm::util::json::Object& result,
+                   const std::vector<bool>& pending,
+                   HintCache& cache);
+
+// Same for a response in the flatbuffers format
+void harvest_hints(const osrm::engine::api::RouteParameters& params,
+                   const flatbuffers::FlatBufferBuilder& result,
+                   const std::vector<bool>& pending,
+                   HintCache& cache);
+void harvest_hints(const osrm::engine::api::TableParameters& params,
+                   const flatbuffers::FlatBufferBuilder& result,
+                   const std::vector<bool>& pending,
+                   HintCache& cache);
+void harvest_hints(const osrm::engine::api::TripParameters& params,
+                   const flatbuffers::FlatBufferBuilder& result,
+                   const std::vector<bool>& pending,
+                   HintCache& cache);
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_HINT_CACHE_H
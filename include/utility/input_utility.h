@@ -0,0 +1,45 @@
+#ifndef OSRM_NB_INPUT_UTIL_H
+#define OSRM_NB_INPUT_UTIL_H
+
+#include "engine/bearing.hpp"
+#include "engine/hint.hpp"
+#include "util/coordinate.hpp"
+
+#include <nanobind/nanobind.h>
+
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace osrm_nb_util {
+
+// Each converter accepts either a Python sequence, converted element by element,
+// or a contiguous NumPy/buffer array, which is copied in bulk without touching
+// a Python object per element.
+
+// (N, 2) float64 degrees or int32 fixed-point (degrees * 1e6) longitude/latitude pairs,
+// non-finite degrees become an invalid coordinate. Other integer dtypes are rejected.
+std::vector<osrm::util::Coordinate> to_coordinates(nanobind::handle obj);
+
+// (N,) float64 meters, NaN leaves a radius unset
+std::vector<std::optional<double>> to_radiuses(nanobind::handle obj);
+
+// (N, 2) int16 bearing/range pairs, a negative bearing leaves the entry unset
+std::vector<std::optional<osrm::engine::Bearing>> to_bearings(nanobind::handle obj);
+
+// (N,) unsigned integers, used for sources, destinations and waypoints
+std::vector<std::size_t> to_indices(nanobind::handle obj, const char* name);
+
+// (N, 2) unsigned integer index pairs, used for the (source, destination) pairs of TablePairs
+std::vector<std::pair<std::size_t, std::size_t>> to_index_pairs(nanobind::handle obj, const char* name);
+
+// (N,) unsigned integer UNIX timestamps
+std::vector<unsigned> to_timestamps(nanobind::handle obj);
+
+// (N,) base64 hints as returned in the waypoints of a response, None leaves a hint unset
+std::vector<std::optional<osrm::engine::Hint>> to_hints(nanobind::handle obj);
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_INPUT_UTIL_H
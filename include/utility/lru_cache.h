@@ -0,0 +1,190 @@
+#ifndef OSRM_NB_LRU_CACHE_H
+#define OSRM_NB_LRU_CACHE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace osrm_nb_util {
+
+// Thread-safe LRU cache. Entries are spread over independently locked shards, each
+// holding an equal share of the entry and byte budget. A budget of 0 leaves that
+// dimension unbounded.
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class ShardedLruCache {
+public:
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;
+        std::size_t entries = 0;
+        std::size_t bytes = 0;
+    };
+
+    ShardedLruCache(std::size_t max_entries, std::size_t max_bytes, std::size_t num_shards = 16) {
+        // Small budgets get fewer shards, so that the LRU order stays meaningful within each
+        if(max_entries > 0) {
+            num_shards = std::min(num_shards, std::max<std::size_t>(max_entries / 64, 1));
+        }
+        num_shards = std::max<std::size_t>(num_shards, 1);
+
+        shard_max_entries = max_entries / num_shards;
+        shard_max_bytes = max_bytes == 0 ? 0 : std::max<std::size_t>(max_bytes / num_shards, 1);
+
+        shards.reserve(num_shards);
+        for(std::size_t i = 0; i < num_shards; ++i) {
+            shards.push_back(std::make_unique<Shard>());
+        }
+    }
+
+    ShardedLruCache(const ShardedLruCache&) = delete;
+    ShardedLruCache& operator=(const ShardedLruCache&) = delete;
+
+    // Returns nothing on a miss, a hit becomes the most recently used entry
+    std::optional<Value> get(const Key& key) {
+        Shard& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto itr = shard.entries.find(key);
+        if(itr == shard.entries.end()) {
+            ++misses;
+            return std::nullopt;
+        }
+
+        shard.lru.splice(shard.lru.begin(), shard.lru, itr->second.position);
+        ++hits;
+        return itr->second.value;
+    }
+
+    // bytes is the caller's estimate of the entry's footprint, only used for the byte budget
+    void put(const Key& key, Value value, std::size_t bytes = 0) {
+        if(shard_max_bytes != 0 && bytes > shard_max_bytes) {
+            return;
+        }
+
+        Shard& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto [itr, inserted] = shard.entries.try_emplace(key);
+        if(!inserted) {
+            // A concurrent miss on the same key already stored it
+            shard.lru.splice(shard.lru.begin(), shard.lru, itr->second.position);
+            return;
+        }
+
+        shard.lru.push_front(&itr->first);
+        itr->second = Entry{std::move(value), bytes, shard.lru.begin()};
+        shard.bytes += bytes;
+
+        while(shard.lru.size() > 1 &&
+              ((shard_max_entries != 0 && shard.entries.size() > shard_max_entries) ||
+               (shard_max_bytes != 0 && shard.bytes > shard_max_bytes)))
+        {
+            auto oldest = shard.entries.find(*shard.lru.back());
+            shard.bytes -= oldest->second.bytes;
+            shard.lru.pop_back();
+            shard.entries.erase(oldest);
+            ++evictions;
+        }
+    }
+
+    void clear() {
+        for(auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->lru.clear();
+            shard->entries.clear();
+            shard->bytes = 0;
+        }
+    }
+
+    // Drops the entries whose key satisfies pred, leaving the counters alone
+    template<typename Predicate>
+    void erase_if(Predicate pred) {
+        for(auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            for(auto itr = shard->entries.begin(); itr != shard->entries.end();) {
+                if(pred(itr->first)) {
+                    shard->bytes -= itr->second.bytes;
+                    shard->lru.erase(itr->second.position);
+                    itr = shard->entries.erase(itr);
+                } else {
+                    ++itr;
+                }
+            }
+        }
+    }
+
+    // Entries and bytes of the keys satisfying pred, the counters are those of the whole cache
+    template<typename Predicate>
+    Stats stats_if(Predicate pred) const {
+        Stats stats;
+        stats.hits = hits;
+        stats.misses = misses;
+        stats.evictions = evictions;
+
+        for(const auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            for(const auto& [key, entry] : shard->entries) {
+                if(pred(key)) {
+                    ++stats.entries;
+                    stats.bytes += entry.bytes;
+                }
+            }
+        }
+        return stats;
+    }
+
+    Stats stats() const {
+        Stats stats;
+        stats.hits = hits;
+        stats.misses = misses;
+        stats.evictions = evictions;
+
+        for(const auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            stats.entries += shard->entries.size();
+            stats.bytes += shard->bytes;
+        }
+        return stats;
+    }
+
+private:
+    struct Entry {
+        Value value;
+        std::size_t bytes;
+        typename std::list<const Key*>::iterator position;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<Key, Entry, Hash> entries;
+        std::list<const Key*> lru; // most recently used first
+        std::size_t bytes = 0;
+    };
+
+    Shard& shard_for(const Key& key) {
+        // Mixed so that shards do not correlate with the map's own buckets
+        const std::uint64_t h = static_cast<std::uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+        return *shards[(h >> 32) % shards.size()];
+    }
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::size_t shard_max_entries;
+    std::size_t shard_max_bytes;
+
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> evictions{0};
+};
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_LRU_CACHE_H
@@ -0,0 +1,83 @@
+#ifndef OSRM_NB_MATCH_SESSION_H
+#define OSRM_NB_MATCH_SESSION_H
+
+#include "osrm/osrm.hpp"
+#include "osrm/match_parameters.hpp"
+#include "engine/bearing.hpp"
+#include "engine/hint.hpp"
+#include "util/coordinate.hpp"
+#include "util/json_container.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace osrm_nb_util {
+
+// Incremental map matching of an unbounded trace. Points are buffered until a window is full,
+// the window is matched, and everything before its trailing overlap is final: the overlap only
+// gives the last points future context and is matched again with the next window.
+// The last final point stays in the buffer as the anchor of the next window, pinned through its
+// hint, so that the legs of consecutive windows join up. The buffer never exceeds one window
+// plus the points of a single push.
+class MatchSession {
+public:
+    struct Point {
+        osrm::util::Coordinate coordinate;
+        std::optional<unsigned> timestamp;
+        std::optional<double> radius;
+        std::optional<osrm::engine::Bearing> bearing;
+    };
+
+    // options supplies every setting except the per-coordinate ones, window is the number of
+    // points per Match request and overlap the number of trailing points that are matched again.
+    // The session keeps matching on engine after the handle swapped datasets, as its anchor
+    // hint belongs to that dataset.
+    MatchSession(std::shared_ptr<const osrm::OSRM> engine, const osrm::engine::api::MatchParameters& options, std::size_t window, std::size_t overlap);
+
+    MatchSession(const MatchSession&) = delete;
+    MatchSession& operator=(const MatchSession&) = delete;
+
+    // Appends points and matches every full window. Returns {"tracepoints", "legs"} of the points
+    // that became final, with global point indices and matching ids. Safe to call without the GIL.
+    osrm::util::json::Object push(const std::vector<Point>& points);
+
+    // Matches the remaining points and returns them, the session can be reused afterwards
+    osrm::util::json::Object finish();
+
+    // Number of buffered points that were not returned yet
+    std::size_t pending() const;
+
+private:
+    struct Buffered {
+        Point point;
+        std::uint64_t index;
+    };
+
+    // Matches the buffer and moves its final part into out, all of it when flush is set
+    void match_window(bool flush, osrm::util::json::Array& tracepoints, osrm::util::json::Array& legs);
+
+    std::shared_ptr<const osrm::OSRM> engine;
+    osrm::engine::api::MatchParameters options;
+    bool keep_hints;
+    std::size_t window;
+    std::size_t overlap;
+
+    mutable std::mutex mutex;
+    std::deque<Buffered> buffer;
+    std::uint64_t next_index = 0;
+    std::optional<bool> has_timestamps;
+
+    // Set while buffer.front() is the already returned anchor
+    std::optional<osrm::engine::Hint> anchor_hint;
+    std::uint64_t anchor_matching = 0;
+    std::uint64_t next_matching = 0;
+};
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_MATCH_SESSION_H
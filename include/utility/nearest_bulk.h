@@ -0,0 +1,33 @@
+#ifndef OSRM_NB_NEAREST_BULK_H
+#define OSRM_NB_NEAREST_BULK_H
+
+#include "osrm/osrm.hpp"
+#include "osrm/nearest_parameters.hpp"
+#include "engine/bearing.hpp"
+#include "util/coordinate.hpp"
+
+#include "utility/array_utility.h"
+#include "utility/thread_pool.h"
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace osrm_nb_util {
+
+// Snaps every coordinate with its own Nearest request, concurrently on the pool, and collects
+// the k nearest results per point into columns. options supplies the settings shared by all
+// points (exclude, snapping), radiuses and bearings are either empty or one per coordinate.
+// A point that fails is reported in the status column instead of aborting the batch.
+// Must be called without the GIL.
+NearestArrays run_nearest_bulk(const osrm::OSRM& engine,
+                               ThreadPool& pool,
+                               const osrm::engine::api::NearestParameters& options,
+                               const std::vector<osrm::util::Coordinate>& coordinates,
+                               const std::vector<std::optional<double>>& radiuses,
+                               const std::vector<std::optional<osrm::engine::Bearing>>& bearings,
+                               std::size_t k);
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_NEAREST_BULK_H
@@ -5,13 +5,17 @@
 #include "osrm/status.hpp"
 #include "util/json_container.hpp"
 
+#include <flatbuffers/flatbuffers.h>
+
 #include <nanobind/nanobind.h>
 
 namespace osrm_nb_util {
 
 void check_status(osrm::engine::Status status, osrm::util::json::Object& res);
 
-void populate_cfg_from_kwargs(const nanobind::kwargs& kwargs, osrm::engine::EngineConfig& config);
+void check_status(osrm::engine::Status status, const flatbuffers::FlatBufferBuilder& res);
+
+void populate_cfg_from_kwargs(const nanobind::dict& kwargs, osrm::engine::EngineConfig& config);
 
 } //namespace osrm_nb_util
 
@@ -0,0 +1,41 @@
+#ifndef OSRM_NB_PAIR_TABLE_H
+#define OSRM_NB_PAIR_TABLE_H
+
+#include "osrm/osrm.hpp"
+#include "osrm/table_parameters.hpp"
+#include "util/coordinate.hpp"
+
+#include "utility/array_utility.h"
+#include "utility/thread_pool.h"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace osrm_nb_util {
+
+using IndexPair = std::pair<std::size_t, std::size_t>;
+
+// Merges origins and destinations into one list of distinct coordinates, and returns the
+// pairs (origins[i], destinations[i]) as indices into it
+std::vector<IndexPair> pairs_from_arrays(const std::vector<osrm::util::Coordinate>& origins,
+                                         const std::vector<osrm::util::Coordinate>& destinations,
+                                         std::vector<osrm::util::Coordinate>& coordinates);
+
+// Computes the Table cells of (source, destination) pairs indexing params.coordinates, whose
+// sources and destinations are ignored. The pairs are grouped by the side with fewer distinct
+// coordinates: coordinates wanting the same set of partners share a sub-Table, and sub-Tables are
+// merged while at least half of their cells are wanted and they fit block_size x block_size.
+// The sub-Tables run concurrently on the pool. A block_size of 0 picks one fitting max_locations
+// (max_locations_distance_table, <= 0 for unlimited). Must be called without the GIL, throws on
+// the first failing sub-Table.
+PairArrays run_pair_table(const osrm::OSRM& engine,
+                          ThreadPool& pool,
+                          const osrm::engine::api::TableParameters& params,
+                          const std::vector<IndexPair>& pairs,
+                          std::size_t block_size,
+                          int max_locations);
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_PAIR_TABLE_H
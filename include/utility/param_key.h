@@ -0,0 +1,26 @@
+#ifndef OSRM_NB_PARAM_KEY_H
+#define OSRM_NB_PARAM_KEY_H
+
+#include "engine/api/match_parameters.hpp"
+#include "engine/api/nearest_parameters.hpp"
+#include "engine/api/route_parameters.hpp"
+#include "engine/api/table_parameters.hpp"
+#include "engine/api/trip_parameters.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace osrm_nb_util {
+
+// Serializes every field that influences the engine's response into a byte string.
+// Two parameter objects produce the same key exactly when they describe the same request,
+// exclude classes are compared regardless of their order.
+std::string canonical_key(const osrm::engine::api::MatchParameters& params);
+std::string canonical_key(const osrm::engine::api::NearestParameters& params);
+std::string canonical_key(const osrm::engine::api::RouteParameters& params);
+std::string canonical_key(const osrm::engine::api::TableParameters& params);
+std::string canonical_key(const osrm::engine::api::TripParameters& params);
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_PARAM_KEY_H
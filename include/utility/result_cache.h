@@ -0,0 +1,32 @@
+#ifndef OSRM_NB_RESULT_CACHE_H
+#define OSRM_NB_RESULT_CACHE_H
+
+#include "util/json_container.hpp"
+
+#include <flatbuffers/flatbuffers.h>
+
+#include "utility/lru_cache.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace osrm_nb_util {
+
+// A successful engine response: the JSON tree, or the finished buffer of a request in the flatbuffers format
+struct CachedResponse {
+    osrm::util::json::Object json;
+    std::shared_ptr<const flatbuffers::DetachedBuffer> flatbuffer;
+};
+
+// Successful engine responses, keyed by a service tag followed by canonical_key(), which includes the format
+using ResultCache = ShardedLruCache<std::string, std::shared_ptr<const CachedResponse>>;
+
+// Rough heap footprint of a response, used for the byte budget
+std::size_t approximate_size(const CachedResponse& response);
+std::size_t approximate_size(const osrm::util::json::Object& object);
+std::size_t approximate_size(const osrm::util::json::Value& value);
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_RESULT_CACHE_H
@@ -0,0 +1,123 @@
+#ifndef OSRM_NB_SERVICE_STATS_H
+#define OSRM_NB_SERVICE_STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace osrm_nb_util {
+
+// Lock-free log-linear histogram in the style of HdrHistogram: every power of two is split
+// into 8 linear sub-buckets, so that recorded values keep a relative precision of 12.5%.
+class Histogram {
+public:
+    static constexpr unsigned sub_bucket_bits = 3;
+    static constexpr std::size_t sub_buckets = std::size_t(1) << sub_bucket_bits;
+    static constexpr std::size_t num_buckets = (64 - sub_bucket_bits + 1) * sub_buckets;
+
+    struct Snapshot {
+        std::uint64_t count = 0;
+        std::uint64_t sum = 0;
+        std::uint64_t max = 0;
+        std::array<std::uint64_t, num_buckets> buckets{};
+
+        // Highest value of the bucket holding quantile q, 0 when empty
+        std::uint64_t quantile(double q) const;
+    };
+
+    void record(std::uint64_t value);
+    Snapshot snapshot() const;
+    void reset();
+
+private:
+    std::array<std::atomic<std::uint64_t>, num_buckets> buckets{};
+    std::atomic<std::uint64_t> sum{0};
+    std::atomic<std::uint64_t> max{0};
+};
+
+// What a request spends its time (in nanoseconds) and response size (in bytes) on
+enum class Phase : std::size_t {
+    Build,
+    Validation,
+    Engine,
+    Conversion,
+    ResponseSize,
+    Count
+};
+
+enum class StatsService : std::size_t {
+    Match,
+    Nearest,
+    Route,
+    Table,
+    Trip,
+    Tile,
+    Count
+};
+
+const char* phase_name(Phase phase);
+const char* service_name(StatsService service);
+
+// Status codes the engine reports, anything else is counted as "Error"
+constexpr std::array<const char*, 15> status_codes {
+    "Ok", "InvalidOptions", "InvalidValue", "InvalidQuery", "InvalidUrl", "InvalidService", "InvalidVersion",
+    "NoSegment", "NoRoute", "NoTable", "NoMatch", "NoTrips", "TooBig", "NotImplemented", "Error"
+};
+
+struct ServiceStats {
+    std::array<Histogram, static_cast<std::size_t>(Phase::Count)> phases;
+    std::array<std::atomic<std::uint64_t>, status_codes.size()> codes{};
+
+    Histogram& phase(Phase p) { return phases[static_cast<std::size_t>(p)]; }
+    void count(const std::string& code);
+    void reset();
+};
+
+// Per-service counters of an OSRM instance, recorded without locks from any thread
+class StatsRegistry {
+public:
+    ServiceStats& service(StatsService s) { return services[static_cast<std::size_t>(s)]; }
+    const ServiceStats& service(StatsService s) const { return services[static_cast<std::size_t>(s)]; }
+    // Durations of the dataset swaps of the instance, in nanoseconds
+    Histogram& swaps() { return swap_durations; }
+    const Histogram& swaps() const { return swap_durations; }
+    void reset();
+
+    // Prometheus text exposition format, durations in seconds
+    std::string prometheus() const;
+
+private:
+    std::array<ServiceStats, static_cast<std::size_t>(StatsService::Count)> services;
+    Histogram swap_durations;
+};
+
+// Parameter objects are built before they reach an OSRM instance, so their construction
+// time is recorded process-wide and reported by every instance
+Histogram& build_histogram(StatsService service);
+
+// Records the time from construction to destruction into a histogram
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() { histogram.record(elapsed_ns(start)); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    static std::uint64_t elapsed_ns(std::chrono::steady_clock::time_point since) {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - since).count());
+    }
+
+private:
+    Histogram& histogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_SERVICE_STATS_H
@@ -0,0 +1,45 @@
+#ifndef OSRM_NB_THREAD_POOL_H
+#define OSRM_NB_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace osrm_nb_util {
+
+// Fixed-size pool of worker threads. Tasks never touch Python objects, so
+// callers are expected to release the GIL before waiting on the pool.
+class ThreadPool {
+public:
+    // A num_threads of 0 uses std::thread::hardware_concurrency()
+    explicit ThreadPool(std::size_t num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return workers.size(); }
+
+    void submit(std::function<void()> task);
+
+    // Runs fn(i) for every i in [0, n) on the pool and the calling thread, and returns
+    // once all of them finished. The first exception thrown by fn is rethrown here.
+    void parallel_for(std::size_t n, const std::function<void(std::size_t)>& fn);
+
+private:
+    void worker_loop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+};
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_THREAD_POOL_H
@@ -0,0 +1,43 @@
+#ifndef OSRM_NB_TILE_PYRAMID_H
+#define OSRM_NB_TILE_PYRAMID_H
+
+#include "osrm/osrm.hpp"
+
+#include "utility/thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace osrm_nb_util {
+
+enum class TileStoreFormat {
+    // {path}/{z}/{x}/{y}.mvt, duplicate tiles are hard links to the first one
+    Directory,
+    // A single file: "OSRMTIL1", the tile blobs, then the index of little-endian
+    // (u8 z, u32 x, u32 y, u64 offset, u32 size) entries sorted by z/x/y, and the footer
+    // (u64 index offset, u64 entry count, "OSRMTIL1"). Duplicate tiles share one blob.
+    Archive
+};
+
+struct TilePyramidStats {
+    std::size_t tiles = 0;
+    std::size_t unique = 0;
+    std::size_t duplicates = 0;
+    std::uint64_t bytes = 0; // bytes of tile data written, without duplicates
+};
+
+// Renders every tile covering the bbox from min_zoom to max_zoom concurrently on the pool and
+// streams them into the store at path. Tiles with identical content, in practice the empty
+// ones, are stored once. Must be called without the GIL, throws on the first failing tile.
+TilePyramidStats render_tile_pyramid(const osrm::OSRM& engine,
+                                     ThreadPool& pool,
+                                     double min_lon, double min_lat,
+                                     double max_lon, double max_lat,
+                                     unsigned min_zoom, unsigned max_zoom,
+                                     const std::string& path,
+                                     TileStoreFormat format);
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_TILE_PYRAMID_H
@@ -0,0 +1,34 @@
+#ifndef OSRM_NB_TILED_TABLE_H
+#define OSRM_NB_TILED_TABLE_H
+
+#include "osrm/osrm.hpp"
+#include "osrm/table_parameters.hpp"
+#include "util/json_container.hpp"
+
+#include "utility/array_utility.h"
+#include "utility/thread_pool.h"
+
+#include <cstddef>
+
+namespace osrm_nb_util {
+
+// A Table assembled from blocks, with the snapped waypoint of every row and column
+struct TiledTable {
+    TableArrays arrays;
+    osrm::util::json::Object waypoints; // {"sources": [...], "destinations": [...]}
+};
+
+// Splits a sources x destinations request into blocks of at most block_size x block_size
+// and runs the blocks concurrently on the pool, writing into one preallocated matrix.
+// Every coordinate is snapped once up front and the blocks reuse the resulting hints.
+// A block_size of 0 picks one fitting max_locations (max_locations_distance_table, <= 0 for unlimited).
+// Must be called without the GIL, throws on the first failing block.
+TiledTable run_tiled_table(const osrm::OSRM& engine,
+                           ThreadPool& pool,
+                           const osrm::engine::api::TableParameters& params,
+                           std::size_t block_size,
+                           int max_locations);
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_TILED_TABLE_H
@@ -0,0 +1,35 @@
+#ifndef OSRM_NB_TRIP_BULK_H
+#define OSRM_NB_TRIP_BULK_H
+
+#include "osrm/osrm.hpp"
+#include "osrm/trip_parameters.hpp"
+#include "util/json_container.hpp"
+
+#include "utility/array_utility.h"
+#include "utility/hint_cache.h"
+#include "utility/thread_pool.h"
+
+#include <string>
+#include <vector>
+
+namespace osrm_nb_util {
+
+struct TripBulk {
+    TripArrays arrays;
+    std::vector<std::string> codes;
+    std::vector<osrm::util::json::Object> results; // only filled when requested
+};
+
+// Solves every Trip request concurrently on the pool without throwing, a failed request is
+// reported through its code. Unless keep_json is set, the geometry, steps and annotations are
+// not generated since only the permutation and totals are returned. params may get its hints
+// filled from hints. Must be called without the GIL.
+TripBulk run_trip_bulk(const osrm::OSRM& engine,
+                       ThreadPool& pool,
+                       std::vector<osrm::engine::api::TripParameters>& params,
+                       bool keep_json,
+                       HintCache* hints);
+
+} //namespace osrm_nb_util
+
+#endif //OSRM_NB_TRIP_BULK_H
@@ -1,11 +1,13 @@
 #include "engineconfig_nb.h"
 
 #include "osrm/engine_config.hpp"
+#include "utility/feature_presets.h"
 #include "utility/osrm_utility.h"
 #include "utility/param_utility.h"
 
 #include <nanobind/nanobind.h>
 #include <nanobind/stl/string.h>
+#include <nanobind/stl/vector.h>
 
 namespace nb = nanobind;
 
@@ -25,8 +27,16 @@ void init_EngineConfig(nb::module_& m) {
         })
         .def("IsValid", &EngineConfig::IsValid)
         .def("SetStorageConfig", [](EngineConfig& self, const std::string& path) {
-            self.storage_config = osrm::storage::StorageConfig(path);
+            osrm_nb_util::set_disabled_features(self, path, { self.disable_feature_dataset.begin(), self.disable_feature_dataset.end() });
         })
+        .def_prop_ro("disable_feature_dataset", [](const EngineConfig& self) {
+            std::vector<std::string> names;
+            for(const auto dataset : self.disable_feature_dataset) {
+                names.push_back(osrm_nb_util::feature_dataset_name(dataset));
+            }
+            return names;
+        }, "Feature datasets ('ROUTE_STEPS', 'ROUTE_GEOMETRY') that are not loaded, set through the disable_feature_dataset \
+            and feature_preset keyword arguments.")
         .def_rw("max_locations_trip", &EngineConfig::max_locations_trip)
         .def_rw("max_locations_viaroute", &EngineConfig::max_locations_viaroute)
         .def_rw("max_locations_distance_table", &EngineConfig::max_locations_distance_table)
@@ -1,10 +1,14 @@
 from .osrm_ext import (
     OSRM,
+    Router,
     EngineConfig,
 
     Approach,
     Bearing,
+    Buffer,
     Coordinate,
+    MatchSession,
+    OutputFormatType,
 
     RouteParameters,
     NearestParameters,
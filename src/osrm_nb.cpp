@@ -7,16 +7,46 @@
 #include "osrm/table_parameters.hpp"
 #include "osrm/tile_parameters.hpp"
 #include "osrm/trip_parameters.hpp"
+#include "util/json_renderer.hpp"
 
 #include <nanobind/nanobind.h>
+#include <nanobind/stl/optional.h>
 #include <nanobind/stl/string.h>
+#include <nanobind/stl/vector.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
 
+#include "osrm_nb.h"
 #include "engineconfig_nb.h"
+#include "utility/array_utility.h"
+#include "utility/async_executor.h"
+#include "utility/engine_utility.h"
+#include "utility/hint_cache.h"
+#include "utility/input_utility.h"
+#include "utility/match_session.h"
+#include "utility/nearest_bulk.h"
 #include "utility/osrm_utility.h"
+#include "utility/pair_table.h"
+#include "utility/param_key.h"
+#include "utility/param_utility.h"
+#include "utility/result_cache.h"
+#include "utility/service_stats.h"
+#include "utility/tile_pyramid.h"
+#include "utility/tiled_table.h"
+#include "utility/trip_bulk.h"
 #include "types/approach_nb.h"
 #include "types/bearing_nb.h"
+#include "types/buffer_nb.h"
 #include "types/coordinate_nb.h"
 #include "types/jsoncontainer_nb.h"
 #include "types/optional_nb.h"
@@ -30,11 +60,463 @@
 
 namespace nb = nanobind;
 
+namespace {
+
+// Assigns a binding option from the OSRM keyword arguments, returns false for EngineConfig arguments
+bool set_handle_option(HandleOptions& options, const std::string& key, nb::handle value) {
+    static const std::unordered_map<std::string, std::size_t HandleOptions::*> size_options {
+        { "num_threads", &HandleOptions::num_threads },
+        { "max_in_flight", &HandleOptions::max_in_flight },
+        { "cache_max_entries", &HandleOptions::cache_max_entries },
+        { "cache_max_bytes", &HandleOptions::cache_max_bytes },
+        { "snap_cache_entries", &HandleOptions::snap_cache_entries }
+    };
+
+    static const std::unordered_map<std::string, bool HandleOptions::*> bool_options {
+        { "warmup", &HandleOptions::warmup },
+        { "warmup_huge_pages", &HandleOptions::warmup_huge_pages },
+        { "warmup_lock", &HandleOptions::warmup_lock }
+    };
+
+    if(auto itr = size_options.find(key); itr != size_options.end()) {
+        options.*(itr->second) = nb::cast<std::size_t>(value);
+        return true;
+    }
+    if(auto itr = bool_options.find(key); itr != bool_options.end()) {
+        options.*(itr->second) = nb::cast<bool>(value);
+        return true;
+    }
+    return false;
+}
+
+nb::dict warmup_report_to_py(const osrm_nb_util::WarmupReport& report) {
+    nb::dict out;
+    out["bytes"] = report.bytes;
+    out["files"] = report.files;
+    out["seconds"] = report.seconds;
+    out["huge_pages"] = report.huge_pages;
+    out["locked"] = report.locked;
+    return out;
+}
+
+// Everything a service call produces before it is converted into a Python object
+struct ServiceResponse {
+    OutputType output_type = OutputType::Dict;
+    osrm::engine::Status status = osrm::engine::Status::Ok;
+    std::optional<flatbuffers::FlatBufferBuilder> builder;
+    osrm::util::json::Object result;
+    // Set instead of result, or builder, when the response is shared with the result cache
+    osrm_nb_util::ResultCache::Value cached;
+    std::optional<osrm_nb_util::TableArrays> arrays;
+    std::optional<std::vector<osrm_nb_util::RouteArrays>> routes;
+    std::string rendered;
+    // Time spent on the output post-processing without the GIL
+    std::uint64_t conversion_ns = 0;
+
+    const osrm::util::json::Object& json() const { return cached ? cached->json : result; }
+    // Set for a cached response in the flatbuffers format
+    const flatbuffers::DetachedBuffer* cached_flatbuffer() const { return cached ? cached->flatbuffer.get() : nullptr; }
+};
+
+// Per-call coordinates, hints and radiuses replacing those of the parameter object, which then serves as a
+// template whose options were parsed once. Converted while the GIL is held.
+struct Overrides {
+    std::optional<std::vector<osrm::util::Coordinate>> coordinates;
+    std::optional<std::vector<std::optional<osrm::engine::Hint>>> hints;
+    std::optional<std::vector<std::optional<double>>> radiuses;
+    // Only accepted by Match
+    std::optional<std::vector<unsigned>> timestamps;
+};
+
+Overrides to_overrides(nb::handle coordinates, nb::handle hints, nb::handle radiuses, nb::handle timestamps = nb::none()) {
+    Overrides overrides;
+    if(!coordinates.is_none()) {
+        overrides.coordinates = osrm_nb_util::to_coordinates(coordinates);
+    }
+    if(!hints.is_none()) {
+        overrides.hints = osrm_nb_util::to_hints(hints);
+    }
+    if(!radiuses.is_none()) {
+        overrides.radiuses = osrm_nb_util::to_radiuses(radiuses);
+    }
+    if(!timestamps.is_none()) {
+        overrides.timestamps = osrm_nb_util::to_timestamps(timestamps);
+    }
+    return overrides;
+}
+
+// New coordinates also drop the per-coordinate fields of the template that are not overridden
+template<typename Parameters>
+void apply_overrides(Parameters& params, Overrides&& overrides) {
+    if(overrides.coordinates) {
+        params.coordinates = std::move(*overrides.coordinates);
+        params.hints.clear();
+        params.radiuses.clear();
+        params.bearings.clear();
+        params.approaches.clear();
+        if constexpr(std::is_same_v<Parameters, osrm::engine::api::MatchParameters>) {
+            params.timestamps.clear();
+        }
+    }
+    if(overrides.hints) {
+        params.hints = std::move(*overrides.hints);
+    }
+    if(overrides.radiuses) {
+        params.radiuses = std::move(*overrides.radiuses);
+    }
+    if constexpr(std::is_same_v<Parameters, osrm::engine::api::MatchParameters>) {
+        if(overrides.timestamps) {
+            params.timestamps = std::move(*overrides.timestamps);
+        }
+    }
+}
+
+// Rejects invalid parameters and output combinations before anything reaches the engine
+template<typename Parameters>
+void check_request(const Parameters& snapshot, OutputType output_type) {
+    using Service = osrm_nb_util::Service<Parameters>;
+    constexpr bool has_numpy_output = std::is_same_v<Parameters, osrm::engine::api::TableParameters> ||
+                                      std::is_same_v<Parameters, osrm::engine::api::RouteParameters> ||
+                                      std::is_same_v<Parameters, osrm::engine::api::MatchParameters>;
+
+    if(!snapshot.IsValid()) {
+        throw std::runtime_error(Service::invalid_message);
+    }
+    if(snapshot.format == osrm::engine::api::BaseParameters::OutputFormatType::FLATBUFFERS && output_type != OutputType::Dict) {
+        throw std::invalid_argument("The flatbuffers format can not be combined with another output");
+    }
+    if(output_type == OutputType::Numpy && !has_numpy_output) {
+        throw std::invalid_argument("output='numpy' is only supported by Route, Match and Table");
+    }
+}
+
+// The NumPy output of Route and Match is built from the full GeoJSON geometry, whose leg boundaries
+// are found through the distance annotation. Returns whether the distance annotation was requested.
+bool prepare_route_arrays(osrm::engine::api::RouteParameters& snapshot) {
+    using RouteParameters = osrm::engine::api::RouteParameters;
+    // OSRM's operator& on annotation types tests for a common flag
+    const bool distance_requested = snapshot.annotations_type & RouteParameters::AnnotationsType::Distance;
+
+    snapshot.geometries = RouteParameters::GeometriesType::GeoJSON;
+    snapshot.overview = RouteParameters::OverviewType::Full;
+    snapshot.annotations = true;
+    snapshot.annotations_type = snapshot.annotations_type | RouteParameters::AnnotationsType::Distance;
+    return distance_requested;
+}
+
+// Runs the engine, or looks the response up in cache, and the output specific post-processing. Does not touch Python.
+// The unset hints of snapshot are filled from hints when given. The engine time is recorded into stats.
+template<typename Parameters>
+ServiceResponse execute_service(const osrm::OSRM& engine,
+                                Parameters& snapshot,
+                                OutputType output_type,
+                                osrm_nb_util::ResultCache* cache,
+                                const std::string& cache_prefix,
+                                osrm_nb_util::HintCache* hints,
+                                osrm_nb_util::ServiceStats& stats)
+{
+    using Service = osrm_nb_util::Service<Parameters>;
+    constexpr bool is_table = std::is_same_v<Parameters, osrm::engine::api::TableParameters>;
+    constexpr bool is_route = std::is_same_v<Parameters, osrm::engine::api::RouteParameters> ||
+                              std::is_same_v<Parameters, osrm::engine::api::MatchParameters>;
+
+    ServiceResponse response;
+    response.output_type = output_type;
+
+    bool keep_distance = true;
+    if constexpr(is_route) {
+        if(output_type == OutputType::Numpy) {
+            keep_distance = prepare_route_arrays(snapshot);
+        }
+    }
+
+    // check_request only lets the flatbuffers format through with the default output
+    const bool is_flatbuffers = snapshot.format == osrm::engine::api::BaseParameters::OutputFormatType::FLATBUFFERS;
+    {
+        osrm_nb_util::ScopedTimer timer(stats.phase(osrm_nb_util::Phase::Engine));
+
+        // The key is taken before the hints are filled, filled hints do not change the response
+        std::string key;
+        if(cache != nullptr && Service::cacheable) {
+            key = cache_prefix + Service::cache_tag + osrm_nb_util::canonical_key(snapshot);
+            if(auto hit = cache->get(key)) {
+                response.cached = std::move(*hit);
+            }
+        }
+
+        if(!response.cached) {
+            if(is_flatbuffers) {
+                osrm::engine::api::ResultT result = flatbuffers::FlatBufferBuilder();
+                response.status = osrm_nb_util::run_with_hints(engine, snapshot, result, hints);
+                response.builder.emplace(std::move(std::get<flatbuffers::FlatBufferBuilder>(result)));
+            } else {
+                response.status = osrm_nb_util::run_with_hints(engine, snapshot, response.result, hints);
+            }
+
+            // Only successful responses are cached
+            if(response.status == osrm::engine::Status::Ok && !key.empty()) {
+                auto entry = std::make_shared<osrm_nb_util::CachedResponse>();
+                if(response.builder) {
+                    entry->flatbuffer = std::make_shared<const flatbuffers::DetachedBuffer>(response.builder->Release());
+                    response.builder.reset();
+                } else {
+                    entry->json = std::move(response.result);
+                }
+                response.cached = std::move(entry);
+                cache->put(key, response.cached, key.size() + osrm_nb_util::approximate_size(*response.cached));
+            }
+        }
+    }
+    if(is_flatbuffers || response.status != osrm::engine::Status::Ok) {
+        return response;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    if(output_type == OutputType::Bytes) {
+        osrm::util::json::render(response.rendered, response.json());
+    }
+    if constexpr(is_table) {
+        if(output_type == OutputType::Numpy) {
+            response.arrays = osrm_nb_util::table_to_arrays(response.json());
+        }
+    }
+    if constexpr(is_route) {
+        if(output_type == OutputType::Numpy) {
+            response.routes = osrm_nb_util::route_to_arrays(response.json(), keep_distance);
+        }
+    }
+    response.conversion_ns = osrm_nb_util::ScopedTimer::elapsed_ns(start);
+    return response;
+}
+
+// Converts a response into the requested output, raising on an engine error
+nb::object response_to_py(ServiceResponse&& response) {
+    if(response.builder) {
+        osrm_nb_util::check_status(response.status, *response.builder);
+        return nb::cast(Buffer::from_flatbuffer(std::move(*response.builder)));
+    }
+    if(response.cached_flatbuffer()) {
+        return nb::cast(Buffer::from_flatbuffer(response.cached->flatbuffer));
+    }
+
+    osrm_nb_util::check_status(response.status, response.result);
+
+    switch(response.output_type) {
+        case OutputType::Numpy:
+            if(response.routes) {
+                return osrm_nb_util::route_arrays_to_py(std::move(*response.routes), response.json());
+            }
+            return osrm_nb_util::table_arrays_to_py(std::move(*response.arrays), response.json());
+        case OutputType::Bytes:
+            return nb::bytes(response.rendered.data(), response.rendered.size());
+        case OutputType::Object:
+            // The response tree moves into an osrm.Object and is only converted where it is accessed,
+            // a cached response is copied since the cache keeps sharing it
+            if(response.cached) {
+                return nb::cast(osrm::util::json::Object(response.cached->json), nb::rv_policy::move);
+            }
+            return nb::cast(std::move(response.result), nb::rv_policy::move);
+        default:
+            return json_object_to_py(response.json());
+    }
+}
+
+// Converts a response like response_to_py, and records its status code, size and conversion time
+nb::object convert_response(osrm_nb_util::ServiceStats& stats, ServiceResponse&& response) {
+    const std::string code = response.builder ? osrm_nb_util::status_code(response.status, *response.builder)
+                                              : osrm_nb_util::status_code(response.status, response.json());
+    stats.count(code);
+    if(response.status == osrm::engine::Status::Ok) {
+        std::uint64_t size = 0;
+        if(response.builder) {
+            size = response.builder->GetSize();
+        } else if(response.cached_flatbuffer()) {
+            size = response.cached_flatbuffer()->size();
+        } else if(response.output_type == OutputType::Bytes) {
+            size = response.rendered.size();
+        } else {
+            size = osrm_nb_util::approximate_size(response.json());
+        }
+        stats.phase(osrm_nb_util::Phase::ResponseSize).record(size);
+    }
+
+    const std::uint64_t prepared_ns = response.conversion_ns;
+    const auto start = std::chrono::steady_clock::now();
+    nb::object result = response_to_py(std::move(response));
+    stats.phase(osrm_nb_util::Phase::Conversion).record(prepared_ns + osrm_nb_util::ScopedTimer::elapsed_ns(start));
+    return result;
+}
+
+// check_request, timed as the validation phase. A rejected request is counted as InvalidOptions.
+template<typename Parameters>
+void validate_request(osrm_nb_util::ServiceStats& stats, const Parameters& snapshot, OutputType output_type) {
+    osrm_nb_util::ScopedTimer timer(stats.phase(osrm_nb_util::Phase::Validation));
+    try {
+        check_request(snapshot, output_type);
+    }
+    catch(...) {
+        stats.count("InvalidOptions");
+        throw;
+    }
+}
+
+// Copies parameters that another Python thread may be modifying. The GIL serializes the copy with
+// the property setters, a free-threaded build locks the Python object like the setters do (nb::lock_self).
+template<typename Parameters>
+Parameters snapshot_parameters(const Parameters& params) {
+#ifdef NB_FREE_THREADED
+    // Parameters built by an implicit conversion have no Python object, nothing else can see them
+    nb::object self = nb::find(params);
+    if(self.is_valid()) {
+        nb::ft_object_guard guard(self);
+        return params;
+    }
+#endif
+    return params;
+}
+
+// Runs a single request with the GIL released and converts the response into the requested output
+template<typename Parameters>
+nb::object run_service(OSRMHandle& handle, const Parameters& params, OutputType output_type, Overrides&& overrides) {
+    osrm_nb_util::ServiceStats& stats = handle.stats().service(osrm_nb_util::Service<Parameters>::stats_service);
+
+    // Snapshot the parameters so that a concurrent Python mutation cannot race the engine
+    Parameters snapshot = snapshot_parameters(params);
+    apply_overrides(snapshot, std::move(overrides));
+    validate_request(stats, snapshot, output_type);
+
+    ServiceResponse response;
+    {
+        nb::gil_scoped_release release;
+        const EnginePin pin = handle.pin();
+        response = execute_service(*pin.engine, snapshot, output_type, handle.cache(), handle.cache_prefix(pin.generation), pin.hints, stats);
+    }
+    return convert_response(stats, std::move(response));
+}
+
+// Same as run_service, but runs on the worker pool and returns an asyncio.Future
+template<typename Parameters>
+nb::object run_service_async(nb::pointer_and_handle<OSRMHandle> self, const Parameters& params, const std::string& output, Overrides&& overrides) {
+    const OutputType output_type = osrm_nb_util::str_to_enum(output, "Output", output_type_map);
+    osrm_nb_util::ServiceStats& stats = self.p->stats().service(osrm_nb_util::Service<Parameters>::stats_service);
+    auto snapshot = std::make_shared<Parameters>(snapshot_parameters(params));
+    apply_overrides(*snapshot, std::move(overrides));
+    validate_request(stats, *snapshot, output_type);
+
+    // The engine is pinned when the request is accepted, a Swap lets it finish on the old dataset
+    // and with the caches of the old dataset
+    EnginePin pin = self.p->pin();
+    osrm_nb_util::ResultCache* cache = self.p->cache();
+    std::string prefix = self.p->cache_prefix(pin.generation);
+    return self.p->executor().submit(self.h, [pin, &stats, cache, prefix, snapshot, output_type] {
+        auto response = std::make_shared<ServiceResponse>(execute_service(*pin.engine, *snapshot, output_type, cache, prefix, pin.hints, stats));
+        return osrm_nb_util::AsyncExecutor::Finisher([&stats, response] {
+            return convert_response(stats, std::move(*response));
+        });
+    });
+}
+
+// Tile counterpart of validate_request
+void validate_tile(osrm_nb_util::ServiceStats& stats, const osrm::engine::api::TileParameters& snapshot) {
+    osrm_nb_util::ScopedTimer timer(stats.phase(osrm_nb_util::Phase::Validation));
+    if(!snapshot.IsValid()) {
+        stats.count("InvalidOptions");
+        throw std::runtime_error("Invalid Tile Parameters");
+    }
+}
+
+// Tiles are returned as they are, their size is recorded with their status
+void record_tile(osrm_nb_util::ServiceStats& stats, osrm::engine::Status status, const std::string& tile) {
+    if(status == osrm::engine::Status::Ok) {
+        stats.count("Ok");
+        stats.phase(osrm_nb_util::Phase::ResponseSize).record(tile.size());
+    } else {
+        stats.count("Error");
+    }
+}
+
+// Summary of a histogram, values are multiplied by scale
+nb::dict histogram_to_py(const osrm_nb_util::Histogram& histogram, double scale) {
+    const osrm_nb_util::Histogram::Snapshot snap = histogram.snapshot();
+    nb::dict out;
+    out["count"] = snap.count;
+    out["mean"] = snap.count > 0 ? static_cast<double>(snap.sum) * scale / static_cast<double>(snap.count) : 0.0;
+    out["p50"] = static_cast<double>(snap.quantile(0.5)) * scale;
+    out["p90"] = static_cast<double>(snap.quantile(0.9)) * scale;
+    out["p99"] = static_cast<double>(snap.quantile(0.99)) * scale;
+    out["p999"] = static_cast<double>(snap.quantile(0.999)) * scale;
+    out["max"] = static_cast<double>(snap.max) * scale;
+    return out;
+}
+
+// The counters and histograms reported by OSRM.Stats
+nb::dict stats_to_py(OSRMHandle& handle) {
+    using osrm_nb_util::Phase;
+    using osrm_nb_util::StatsService;
+
+    nb::dict stats;
+    for(std::size_t s = 0; s < static_cast<std::size_t>(StatsService::Count); ++s) {
+        const auto service = static_cast<StatsService>(s);
+        const osrm_nb_util::ServiceStats& counters = handle.stats().service(service);
+
+        nb::dict entry;
+        nb::dict codes;
+        std::uint64_t requests = 0;
+        for(std::size_t c = 0; c < osrm_nb_util::status_codes.size(); ++c) {
+            const std::uint64_t value = counters.codes[c].load(std::memory_order_relaxed);
+            requests += value;
+            if(value > 0) {
+                codes[osrm_nb_util::status_codes[c]] = value;
+            }
+        }
+        entry["requests"] = requests;
+        entry["codes"] = codes;
+        for(std::size_t p = 0; p < static_cast<std::size_t>(Phase::Count); ++p) {
+            const auto phase = static_cast<Phase>(p);
+            const osrm_nb_util::Histogram& histogram = phase == Phase::Build ? osrm_nb_util::build_histogram(service) : counters.phases[p];
+            entry[osrm_nb_util::phase_name(phase)] = histogram_to_py(histogram, phase == Phase::ResponseSize ? 1.0 : 1e-9);
+        }
+        stats[osrm_nb_util::service_name(service)] = entry;
+    }
+    stats["swap"] = histogram_to_py(handle.stats().swaps(), 1e-9);
+    return stats;
+}
+
+OSRMHandle& router_profile(Router& router, const std::string& name) {
+    OSRMHandle* handle = router.profile(name);
+    if(handle == nullptr) {
+        throw nb::key_error(("Unknown profile: " + name).c_str());
+    }
+    return *handle;
+}
+
+// Runs a list of requests on the handle's worker pool and returns (results, codes)
+template<typename Parameters>
+nb::tuple run_many(OSRMHandle& handle, const std::vector<Parameters>& params) {
+    std::vector<osrm::util::json::Object> results;
+    std::vector<std::string> codes;
+    {
+        nb::gil_scoped_release release;
+        const EnginePin pin = handle.pin();
+        osrm_nb_util::run_batch(*pin.engine, handle.pool(), params, results, codes, pin.hints);
+    }
+
+    nb::list py_results;
+    nb::list py_codes;
+    for(std::size_t i = 0; i < results.size(); ++i) {
+        py_results.append(json_object_to_py(results[i]));
+        py_codes.append(nb::str(codes[i].c_str(), codes[i].size()));
+    }
+
+    return nb::make_tuple(py_results, py_codes);
+}
+
+} //namespace
+
 NB_MODULE(osrm_ext, m) {
     namespace api = osrm::engine::api;
     namespace json = osrm::util::json;
 
-    using osrm::OSRM;
     using osrm::engine::EngineConfig;
     using osrm::engine::api::MatchParameters;
     using osrm::engine::api::NearestParameters;
@@ -47,6 +529,7 @@ NB_MODULE(osrm_ext, m) {
 
     init_Approach(m);
     init_Bearing(m);
+    init_Buffer(m);
     init_Coordinate(m);
     init_JSONContainer(m);
     init_Optional(m);
@@ -59,7 +542,72 @@ NB_MODULE(osrm_ext, m) {
     init_TripParameters(m);
     init_TileParameters(m);
 
-    nb::class_<OSRM>(m, "OSRM", nb::is_final())
+    nb::class_<osrm_nb_util::MatchSession>(m, "MatchSession", nb::is_final(),
+            "Incremental map matching of an unbounded GPS trace, created by OSRM.MatchSession.\n\n"
+            "Examples:\n\
+                >>> session = py_osrm.MatchSession(window = 100, overlap = 20)\n\
+                >>> for coordinates, timestamps in batches:\n\
+                ...     res = session.Push(coordinates, timestamps = timestamps)\n\
+                >>> res = session.Finish()\n\n"
+            "Attributes:\n\
+                pending (int): Number of pushed points that were not returned yet."
+            )
+        .def("Push", [](osrm_nb_util::MatchSession& session,
+                        nb::handle coordinates,
+                        nb::handle timestamps,
+                        nb::handle radiuses,
+                        nb::handle bearings) {
+            const auto points = osrm_nb_util::to_coordinates(coordinates);
+            const auto point_timestamps = timestamps.is_none() ? std::vector<unsigned>() : osrm_nb_util::to_timestamps(timestamps);
+            const auto point_radiuses = radiuses.is_none() ? std::vector<std::optional<double>>() : osrm_nb_util::to_radiuses(radiuses);
+            const auto point_bearings = bearings.is_none() ? std::vector<std::optional<osrm::engine::Bearing>>() : osrm_nb_util::to_bearings(bearings);
+            if((!point_timestamps.empty() && point_timestamps.size() != points.size()) ||
+               (!point_radiuses.empty() && point_radiuses.size() != points.size()) ||
+               (!point_bearings.empty() && point_bearings.size() != points.size())) {
+                throw std::invalid_argument("timestamps, radiuses and bearings must have one entry per coordinate");
+            }
+
+            std::vector<osrm_nb_util::MatchSession::Point> batch(points.size());
+            for(std::size_t i = 0; i < points.size(); ++i) {
+                batch[i].coordinate = points[i];
+                if(!point_timestamps.empty()) batch[i].timestamp = point_timestamps[i];
+                if(!point_radiuses.empty()) batch[i].radius = point_radiuses[i];
+                if(!point_bearings.empty()) batch[i].bearing = point_bearings[i];
+            }
+
+            osrm::util::json::Object result;
+            {
+                nb::gil_scoped_release release;
+                result = session.push(batch);
+            }
+            return json_object_to_py(result);
+    }, nb::arg("coordinates"), nb::arg("timestamps") = nb::none(), nb::arg("radiuses") = nb::none(), nb::arg("bearings") = nb::none(),
+            "Appends points to the trace and matches every window that became full.\n\n"
+            "Args:\n\
+                coordinates (numpy.ndarray or list): (N, 2) longitude/latitude pairs.\n\
+                timestamps (numpy.ndarray or list): Optional (N,) UNIX timestamps, given for every push or for none. (default None)\n\
+                radiuses (numpy.ndarray or list): Optional (N,) GPS precision in meters, NaN for the default. (default None)\n\
+                bearings (numpy.ndarray or list): Optional (N, 2) bearing/range pairs. (default None)\n\n"
+            "Returns:\n\
+                (dict): 'tracepoints', one per point that became final in input order, None for unmatched points, \
+                    with its global 'index' and a 'matchings_index' that is stable across windows, \
+                    and 'legs', the Match legs between consecutive final points of a matching, \
+                    with 'matching', 'from' and 'to' point indices.\n\n"
+            "Raises:\n\
+                ValueError: On malformed inputs, or timestamps given for only some pushes.\n\
+                RuntimeError: On an engine error other than NoMatch/NoSegment."
+            )
+        .def("Finish", [](osrm_nb_util::MatchSession& session) {
+            osrm::util::json::Object result;
+            {
+                nb::gil_scoped_release release;
+                result = session.finish();
+            }
+            return json_object_to_py(result);
+    }, "Matches and returns the remaining points in the same format as Push. The session starts a new trace afterwards.")
+        .def_prop_ro("pending", &osrm_nb_util::MatchSession::pending);
+
+    nb::class_<OSRMHandle>(m, "OSRM", nb::is_final())
         .def(nb::init<EngineConfig&>(), "Instantiates an instance of OSRM.\n\n"
             "Examples:\n\
                 >>> import osrm\n\
@@ -73,17 +621,34 @@ NB_MODULE(osrm_ext, m) {
                         max_locations_map_matching = 3,\n\
                         max_results_nearest = 1,\n\
                         max_alternatives = 1,\n\
-                        default_radius = 'unlimited'\n\
+                        default_radius = 'unlimited',\n\
+                        num_threads = 8,\n\
+                        max_in_flight = 16\n\
                     )\n\n"
             "Args:\n\
                 storage_config (string): File path string to storage config.\n\
+                feature_preset (string 'full' | 'table_only' | 'nearest_only'): Leaves out the feature datasets that the services \
+                    of the preset do not use, see ComparePresets. 'table_only' serves Table durations, 'nearest_only' Nearest. (default 'full')\n\
+                disable_feature_dataset (list of 'ROUTE_STEPS' | 'ROUTE_GEOMETRY'): Feature datasets not to load, on top of those of \
+                    feature_preset. Requests needing them fail with a DisabledDataset error. (default [])\n\
+                num_threads (int): Size of the worker pool used by the batch and async services, 0 uses all cores. (default 0)\n\
+                max_in_flight (int): Maximum number of async requests running on the worker pool at once, \
+                    further requests wait for a free slot. 0 uses num_threads. (default 0)\n\
+                cache_max_entries (int): Enables an LRU cache of Route, Table, Nearest and Trip responses holding at most this many entries, \
+                    0 for no entry limit. (default 0)\n\
+                cache_max_bytes (int): Enables the response cache with an approximate memory budget in bytes, 0 for no byte limit. (default 0)\n\
+                snap_cache_entries (int): Enables a cache of the snapped location (hint) of up to this many coordinates, \
+                    used by Route, Table and Trip to skip snapping coordinates seen before. (default 0)\n\
+                warmup (bool): Runs Warmup before the constructor returns, see LastWarmup for its report. (default False)\n\
+                warmup_huge_pages (bool): The huge_pages argument of the constructor warm-up. (default False)\n\
+                warmup_lock (bool): The lock argument of the constructor warm-up. (default False)\n\
                 EngineConfig (osrm.osrm_ext.EngineConfig): Keyword arguments from the EngineConfig class.\n\n"
             "Returns:\n\
                 __init__ (osrm.OSRM): A OSRM object.\n\n"
             "Raises:\n\
                 RuntimeError: On invalid OSRM EngineConfig parameters."
             )
-        .def("__init__", [](OSRM* t, const std::string& storage_path) { 
+        .def("__init__", [](OSRMHandle* t, const std::string& storage_path) {
             EngineConfig config;
             config.storage_config = osrm::storage::StorageConfig(storage_path);
 
@@ -91,131 +656,957 @@ NB_MODULE(osrm_ext, m) {
                 throw std::runtime_error("Required files are missing");
             }
 
-            new (t) OSRM(config);
+            new (t) OSRMHandle(config);
         })
-        .def("__init__", [](OSRM* t, const nb::kwargs& kwargs) {
+        .def("__init__", [](OSRMHandle* t, const nb::kwargs& kwargs) {
+            HandleOptions options;
+            nb::dict cfg_kwargs;
+            for(auto kwarg : kwargs) {
+                if(!set_handle_option(options, nb::cast<std::string>(kwarg.first), kwarg.second)) {
+                    cfg_kwargs[kwarg.first] = kwarg.second;
+                }
+            }
+
             EngineConfig config;
-            osrm_nb_util::populate_cfg_from_kwargs(kwargs, config);
+            osrm_nb_util::populate_cfg_from_kwargs(cfg_kwargs, config);
 
             if(!config.IsValid()) {
                 throw std::runtime_error("Config Parameters are Invalid");
             }
 
-            new (t) OSRM(config);
-        })
-    .def("Match", [](OSRM* t, const MatchParameters& params) {
-            if(!params.IsValid()) {
-                throw std::runtime_error("Invalid Match Parameters");
+            new (t) OSRMHandle(config, options);
+            if(options.warmup) {
+                try {
+                    nb::gil_scoped_release release;
+                    t->warmup({ options.warmup_huge_pages, options.warmup_lock });
+                }
+                catch(...) {
+                    // nanobind only destroys objects whose __init__ succeeded
+                    t->~OSRMHandle();
+                    throw;
+                }
             }
-
-            json::Object result;
-            osrm::engine::Status status = t->Match(params, result);
-            osrm_nb_util::check_status(status, result);
-            return json_object_to_py(result);
-    }, "Matches/snaps given GPS points to the road network in the most plausible way.\n\n"
+        })
+    .def("Match", [](OSRMHandle* t, const MatchParameters& params, const std::string& output,
+                     nb::handle coordinates, nb::handle hints, nb::handle radiuses, nb::handle timestamps) {
+            return run_service(*t, params, osrm_nb_util::str_to_enum(output, "Output", output_type_map),
+                               to_overrides(coordinates, hints, radiuses, timestamps));
+    }, nb::arg("match_params"), nb::arg("output") = "dict",
+       nb::arg("coordinates") = nb::none(), nb::arg("hints") = nb::none(), nb::arg("radiuses") = nb::none(),
+       nb::arg("timestamps") = nb::none(),
+            "Matches/snaps given GPS points to the road network in the most plausible way.\n\n"
             "Examples:\n\
                 >>> res = py_osrm.Match(match_params)\n\n"
             "Args:\n\
-                match_params (osrm.MatchParameters): MatchParameters Object.\n\n"
+                match_params (osrm.MatchParameters): MatchParameters Object.\n\
+                output (string 'dict' | 'object' | 'bytes' | 'numpy'): 'object' returns an osrm.Object proxy that converts only the parts of the response that are accessed, \
+                    'bytes' returns the response rendered to UTF-8 JSON, 'numpy' returns the matchings and tracepoints like Route does \
+                    its routes and waypoints. (default 'dict')\n\
+                coordinates (numpy.ndarray or list): Replaces the coordinates of match_params, which then serves as a prepared template \
+                    whose options are not parsed again. Its hints, radiuses, bearings, approaches and timestamps are dropped. (default None)\n\
+                hints (list): Replaces the hints, base64 strings from the waypoints of an earlier response or None. (default None)\n\
+                radiuses (numpy.ndarray or list): Replaces the radiuses in meters, NaN leaves one unset. (default None)\n\
+                timestamps (numpy.ndarray or list): Replaces the UNIX timestamps. (default None)\n\n"
             "Returns:\n\
                 (json): [A Match JSON Response](https://project-osrm.org/docs/v5.24.0/api/#match-service).\n\n"
             "Raises:\n\
                 RuntimeError: On invalid MatchParameters."
             )
-        .def("Nearest", [](OSRM* t, const NearestParameters& params) {
-            if(!params.IsValid()) {
-                throw std::runtime_error("Invalid Nearest Parameters");
-            }
-
-            json::Object result;
-            osrm::engine::Status status = t->Nearest(params, result);
-            osrm_nb_util::check_status(status, result);
-            return json_object_to_py(result);
-    }, "Snaps a coordinate to the street network and returns the nearest matches.\n\n"
+        .def("Nearest", [](OSRMHandle* t, const NearestParameters& params, const std::string& output,
+                           nb::handle coordinates, nb::handle hints, nb::handle radiuses) {
+            return run_service(*t, params, osrm_nb_util::str_to_enum(output, "Output", output_type_map),
+                               to_overrides(coordinates, hints, radiuses));
+    }, nb::arg("nearest_params"), nb::arg("output") = "dict",
+       nb::arg("coordinates") = nb::none(), nb::arg("hints") = nb::none(), nb::arg("radiuses") = nb::none(),
+            "Snaps a coordinate to the street network and returns the nearest matches.\n\n"
             "Examples:\n\
                 >>> res = py_osrm.Nearest(nearest_params)\n\n"
             "Args:\n\
-                nearest_params (osrm.NearestParameters): NearestParameters Object.\n\n"
+                nearest_params (osrm.NearestParameters): NearestParameters Object.\n\
+                output (string 'dict' | 'object' | 'bytes'): 'object' returns an osrm.Object proxy that converts only the parts of the response that are accessed, \
+                    'bytes' returns the response rendered to UTF-8 JSON. (default 'dict')\n\
+                coordinates (numpy.ndarray or list): Replaces the coordinates of nearest_params, which then serves as a prepared template \
+                    whose options are not parsed again. Its hints, radiuses, bearings and approaches are dropped. (default None)\n\
+                hints (list): Replaces the hints, base64 strings from the waypoints of an earlier response or None. (default None)\n\
+                radiuses (numpy.ndarray or list): Replaces the radiuses in meters, NaN leaves one unset. (default None)\n\n"
             "Returns:\n\
                 (json): [A Nearest JSON Response](https://project-osrm.org/docs/v5.24.0/api/#nearest-service).\n\n"
             "Raises:\n\
                 RuntimeError: On invalid NearestParameters."
             )
-        .def("Route", [](OSRM* t, const RouteParameters& params) {
-            if(!params.IsValid()) {
-                throw std::runtime_error("Invalid Route Parameters");
-            }
-
-            json::Object result;
-            osrm::engine::Status status = t->Route(params, result);
-            osrm_nb_util::check_status(status, result);
-            return json_object_to_py(result);
-    }, "Finds the fastest route between coordinates in the supplied order.\n\n"
+        .def("Route", [](OSRMHandle* t, const RouteParameters& params, const std::string& output,
+                         nb::handle coordinates, nb::handle hints, nb::handle radiuses) {
+            return run_service(*t, params, osrm_nb_util::str_to_enum(output, "Output", output_type_map),
+                               to_overrides(coordinates, hints, radiuses));
+    }, nb::arg("route_params"), nb::arg("output") = "dict",
+       nb::arg("coordinates") = nb::none(), nb::arg("hints") = nb::none(), nb::arg("radiuses") = nb::none(),
+            "Finds the fastest route between coordinates in the supplied order.\n\n"
             "Examples:\n\
-                >>> res = py_osrm.Route(route_params)\n\n"
+                >>> res = py_osrm.Route(route_params)\n\
+                >>> res = py_osrm.Route(route_params, output = 'numpy')\n\
+                >>> res['routes'][0]['geometry'].shape\n\
+                (N, 2)\n\n"
             "Args:\n\
-                route_params (osrm.RouteParameters): RouteParameters Object.\n\n"
+                route_params (osrm.RouteParameters): RouteParameters Object.\n\
+                output (string 'dict' | 'object' | 'bytes' | 'numpy'): 'object' returns an osrm.Object proxy that converts only the parts of the response that are accessed, \
+                    'bytes' returns the response rendered to UTF-8 JSON, 'numpy' returns every route as its full (N, 2) geometry, leg_offsets \
+                    and the requested annotations as arrays, with the waypoints column-wise. (default 'dict')\n\
+                coordinates (numpy.ndarray or list): Replaces the coordinates of route_params, which then serves as a prepared template \
+                    whose options are not parsed again. Its hints, radiuses, bearings and approaches are dropped. (default None)\n\
+                hints (list): Replaces the hints, base64 strings from the waypoints of an earlier response or None. (default None)\n\
+                radiuses (numpy.ndarray or list): Replaces the radiuses in meters, NaN leaves one unset. (default None)\n\n"
             "Returns:\n\
                 (json): [A Route JSON Response](https://project-osrm.org/docs/v5.24.0/api/#route-service).\n\n"
             "Raises:\n\
                 RuntimeError: On invalid RouteParameters."
             )
-        .def("Table", [](OSRM* t, const TableParameters& params) {
-            if(!params.IsValid()) {
-                throw std::runtime_error("Invalid Table Parameters");
-            }
-
-            json::Object result;
-            osrm::engine::Status status = t->Table(params, result);
-            osrm_nb_util::check_status(status, result);
-            return json_object_to_py(result);
-    }, "Computes the duration of the fastest route between all pairs of supplied coordinates.\n\n"
+        .def("Table", [](OSRMHandle* t, const TableParameters& params, const std::string& output,
+                         nb::handle coordinates, nb::handle hints, nb::handle radiuses) {
+            return run_service(*t, params, osrm_nb_util::str_to_enum(output, "Output", output_type_map),
+                               to_overrides(coordinates, hints, radiuses));
+    }, nb::arg("table_params"), nb::arg("output") = "dict",
+       nb::arg("coordinates") = nb::none(), nb::arg("hints") = nb::none(), nb::arg("radiuses") = nb::none(),
+            "Computes the duration of the fastest route between all pairs of supplied coordinates.\n\n"
             "Examples:\n\
-                >>> res = py_osrm.Table(table_params)\n\n"
+                >>> res = py_osrm.Table(table_params)\n\
+                >>> res = py_osrm.Table(table_params, output = 'numpy')\n\
+                >>> res['durations'].shape\n\
+                (2, 2)\n\n"
             "Args:\n\
-                table_params (osrm.TableParameters): TableParameters Object.\n\n"
+                table_params (osrm.TableParameters): TableParameters Object.\n\
+                output (string 'dict' | 'object' | 'bytes' | 'numpy'): 'object' returns an osrm.Object proxy that converts only the parts of the response that are accessed, \
+                    'bytes' returns the response rendered to UTF-8 JSON, 'numpy' returns durations, distances and the fallback_speed_cells mask \
+                    as NumPy matrices (NaN for unreachable pairs), and the sources/destinations waypoints as \
+                    columns (location, distance, name, hint). (default 'dict')\n\
+                coordinates (numpy.ndarray or list): Replaces the coordinates of table_params, which then serves as a prepared template \
+                    whose options are not parsed again. Its hints, radiuses, bearings and approaches are dropped. (default None)\n\
+                hints (list): Replaces the hints, base64 strings from the waypoints of an earlier response or None. (default None)\n\
+                radiuses (numpy.ndarray or list): Replaces the radiuses in meters, NaN leaves one unset. (default None)\n\n"
             "Returns:\n\
                 (json): [A Table JSON Response](https://project-osrm.org/docs/v5.24.0/api/#table-service).\n\n"
             "Raises:\n\
                 RuntimeError: On invalid TableParameters."
             )
-        .def("Tile", [](OSRM* t, const TileParameters& params) {
-            if(!params.IsValid()) {
-                throw std::runtime_error("Invalid Tile Parameters");
-            }
+        .def("Tile", [](OSRMHandle* t, const TileParameters& params) {
+            osrm_nb_util::ServiceStats& stats = t->stats().service(osrm_nb_util::StatsService::Tile);
+            const TileParameters snapshot = snapshot_parameters(params);
+            validate_tile(stats, snapshot);
 
             std::string result;
-            osrm::engine::Status status = t->Tile(params, result);
-            nb::object obj = nb::bytes(result.c_str(), result.size());
-
-            return obj;
-    }, "Computes the duration of the fastest route between all pairs of supplied coordinates.\n\n"
+            {
+                nb::gil_scoped_release release;
+                osrm_nb_util::ScopedTimer timer(stats.phase(osrm_nb_util::Phase::Engine));
+                record_tile(stats, t->engine()->Tile(snapshot, result), result);
+            }
+            // The Buffer takes over the string instead of copying it into bytes
+            return Buffer::from_string(std::move(result));
+    }, nb::arg("tile_params"),
+            "Generates a Mapbox Vector Tile of the road network for debugging.\n\n"
             "Examples:\n\
                 >>> res = py_osrm.Tile(tile_params)\n\n"
             "Args:\n\
                 tile_params (osrm.TileParameters): TileParameters Object.\n\n"
             "Returns:\n\
-                (json): [A Tile JSON Response](https://project-osrm.org/docs/v5.24.0/api/#tile-service).\n\n"
+                (osrm.Buffer): [A Tile Response](https://project-osrm.org/docs/v5.24.0/api/#tile-service), \
+                    readable through the buffer protocol (memoryview, bytes(...)) without a copy.\n\n"
             "Raises:\n\
                 RuntimeError: On invalid TileParameters."
             )
-        .def("Trip", [](OSRM* t, const TripParameters& params) {
-            if(!params.IsValid()) {
-                throw std::runtime_error("Invalid Trip Parameters");
-            }
-
-            json::Object result;
-            osrm::engine::Status status = t->Trip(params, result);
-            osrm_nb_util::check_status(status, result);
-            return json_object_to_py(result);
-    }, "Solves the Traveling Salesman Problem using a greedy heuristic (farthest-insertion algorithm).\n\n"
+        .def("Trip", [](OSRMHandle* t, const TripParameters& params, const std::string& output,
+                        nb::handle coordinates, nb::handle hints, nb::handle radiuses) {
+            return run_service(*t, params, osrm_nb_util::str_to_enum(output, "Output", output_type_map),
+                               to_overrides(coordinates, hints, radiuses));
+    }, nb::arg("trip_params"), nb::arg("output") = "dict",
+       nb::arg("coordinates") = nb::none(), nb::arg("hints") = nb::none(), nb::arg("radiuses") = nb::none(),
+            "Solves the Traveling Salesman Problem using a greedy heuristic (farthest-insertion algorithm).\n\n"
             "Examples:\n\
                 >>> res = py_osrm.Trip(trip_params)\n\n"
             "Args:\n\
-                trip_params (osrm.TripParameters): TripParameters Object.\n\n"
+                trip_params (osrm.TripParameters): TripParameters Object.\n\
+                output (string 'dict' | 'object' | 'bytes'): 'object' returns an osrm.Object proxy that converts only the parts of the response that are accessed, \
+                    'bytes' returns the response rendered to UTF-8 JSON. (default 'dict')\n\
+                coordinates (numpy.ndarray or list): Replaces the coordinates of trip_params, which then serves as a prepared template \
+                    whose options are not parsed again. Its hints, radiuses, bearings and approaches are dropped. (default None)\n\
+                hints (list): Replaces the hints, base64 strings from the waypoints of an earlier response or None. (default None)\n\
+                radiuses (numpy.ndarray or list): Replaces the radiuses in meters, NaN leaves one unset. (default None)\n\n"
             "Returns:\n\
                 (json): [A Trip JSON Response](https://project-osrm.org/docs/v5.24.0/api/#trip-service).\n\n"
             "Raises:\n\
                 RuntimeError: On invalid TripParameters."
+            )
+        .def("TableTiled", [](OSRMHandle* t, const TableParameters& params, std::size_t block_size) {
+            const TableParameters snapshot = snapshot_parameters(params);
+            if(!snapshot.IsValid()) {
+                throw std::runtime_error("Invalid Table Parameters");
+            }
+
+            osrm_nb_util::TiledTable table;
+            {
+                nb::gil_scoped_release release;
+                table = osrm_nb_util::run_tiled_table(*t->engine(), t->pool(), snapshot, block_size, t->max_locations_distance_table());
+            }
+            return osrm_nb_util::table_arrays_to_py(std::move(table.arrays), table.waypoints);
+    }, nb::arg("table_params"), nb::arg("block_size") = 0,
+            "Computes a Table of any size by splitting it into blocks that run concurrently on the worker pool.\n\n"
+            "Examples:\n\
+                >>> res = py_osrm.TableTiled(table_params, block_size = 1000)\n\
+                >>> res['durations'].shape\n\
+                (20000, 20000)\n\n"
+            "Args:\n\
+                table_params (osrm.TableParameters): TableParameters Object, not limited by max_locations_distance_table.\n\
+                block_size (int): Maximum number of sources and of destinations per block, \
+                    0 picks one within max_locations_distance_table. (default 0)\n\n"
+            "Returns:\n\
+                (dict): Same as Table with output = 'numpy'. Every coordinate is snapped once, \
+                    and the blocks are stitched into one durations/distances matrix.\n\n"
+            "Raises:\n\
+                RuntimeError: On invalid TableParameters, a coordinate that can not be snapped, or a failing block."
+            )
+        .def("TablePairs", [](OSRMHandle* t,
+                              const TableParameters& params,
+                              nb::handle pairs,
+                              nb::handle origins,
+                              nb::handle destinations,
+                              std::size_t block_size) {
+            const bool by_index = !pairs.is_none();
+            const bool by_coordinates = !origins.is_none() && !destinations.is_none();
+            if(by_index == by_coordinates || origins.is_none() != destinations.is_none()) {
+                throw std::invalid_argument("Pass either pairs, or both origins and destinations");
+            }
+
+            TableParameters snapshot = snapshot_parameters(params);
+            std::vector<osrm_nb_util::IndexPair> index_pairs;
+            if(by_index) {
+                index_pairs = osrm_nb_util::to_index_pairs(pairs, "pairs");
+            } else {
+                snapshot.coordinates.clear();
+                snapshot.hints.clear();
+                snapshot.radiuses.clear();
+                snapshot.bearings.clear();
+                snapshot.approaches.clear();
+                index_pairs = osrm_nb_util::pairs_from_arrays(osrm_nb_util::to_coordinates(origins),
+                                                              osrm_nb_util::to_coordinates(destinations),
+                                                              snapshot.coordinates);
+            }
+            snapshot.sources.clear();
+            snapshot.destinations.clear();
+            if(!snapshot.IsValid()) {
+                throw std::runtime_error("Invalid Table Parameters");
+            }
+
+            osrm_nb_util::PairArrays arrays;
+            {
+                nb::gil_scoped_release release;
+                arrays = osrm_nb_util::run_pair_table(*t->engine(), t->pool(), snapshot, index_pairs, block_size,
+                                                      t->max_locations_distance_table());
+            }
+            return osrm_nb_util::pair_arrays_to_py(std::move(arrays));
+    }, nb::arg("table_params"), nb::arg("pairs") = nb::none(), nb::arg("origins") = nb::none(),
+       nb::arg("destinations") = nb::none(), nb::arg("block_size") = 0,
+            "Computes the Table cells of a sparse list of origin-destination pairs. Pairs sharing origins or \
+                destinations are grouped into sub-Tables that run concurrently on the worker pool.\n\n"
+            "Examples:\n\
+                >>> res = py_osrm.TablePairs(table_params, pairs = [(0, 1), (0, 2), (3, 1)])\n\
+                >>> res['durations']\n\
+                array([ 812.4, 1021.9,  230.5])\n\
+                >>> res = py_osrm.TablePairs(table_params, origins = origins, destinations = destinations)\n\n"
+            "Args:\n\
+                table_params (osrm.TableParameters): TableParameters Object, its sources and destinations are ignored.\n\
+                pairs (list | numpy.ndarray): (n, 2) (source, destination) indices into table_params.coordinates.\n\
+                origins (list | numpy.ndarray): n origin coordinates, replacing the coordinates and their \
+                    per-coordinate options of table_params. Must be passed with destinations.\n\
+                destinations (list | numpy.ndarray): n destination coordinates, paired with origins by position.\n\
+                block_size (int): Maximum number of sources and of destinations per sub-Table, \
+                    0 picks one within max_locations_distance_table. (default 0)\n\n"
+            "Returns:\n\
+                (dict): code, durations and distances as (n,) numpy arrays aligned with the pairs \
+                    (None when not annotated, NaN when unreachable), fallback_speed_cells as an (n,) bool array, \
+                    and sub_tables, the number of Table requests made.\n\n"
+            "Raises:\n\
+                ValueError: When neither or both of pairs and origins/destinations are passed, on mismatched \
+                    origins and destinations, or on an index out of range.\n\
+                RuntimeError: On invalid TableParameters or a failing sub-Table."
+            )
+        .def("RenderTiles", [](OSRMHandle* t,
+                               std::vector<double> bbox,
+                               unsigned min_zoom,
+                               unsigned max_zoom,
+                               const std::string& path,
+                               const std::string& format) {
+            static const std::unordered_map<std::string, osrm_nb_util::TileStoreFormat> format_map {
+                { "directory", osrm_nb_util::TileStoreFormat::Directory },
+                { "archive", osrm_nb_util::TileStoreFormat::Archive }
+            };
+            const auto store_format = osrm_nb_util::str_to_enum(format, "Tile Store Format", format_map);
+            if(bbox.size() != 4) {
+                throw std::invalid_argument("bbox must be (min_lon, min_lat, max_lon, max_lat)");
+            }
+
+            osrm_nb_util::TilePyramidStats counters;
+            {
+                nb::gil_scoped_release release;
+                counters = osrm_nb_util::render_tile_pyramid(*t->engine(), t->pool(), bbox[0], bbox[1], bbox[2], bbox[3],
+                                                             min_zoom, max_zoom, path, store_format);
+            }
+
+            nb::dict stats;
+            stats["tiles"] = counters.tiles;
+            stats["unique"] = counters.unique;
+            stats["duplicates"] = counters.duplicates;
+            stats["bytes"] = counters.bytes;
+            return stats;
+    }, nb::arg("bbox"), nb::arg("min_zoom"), nb::arg("max_zoom"), nb::arg("path"), nb::arg("format") = "directory",
+            "Renders every tile covering a bounding box over a range of zoom levels concurrently on the worker pool, \
+                and writes them to a local tile store.\n\n"
+            "Examples:\n\
+                >>> py_osrm.RenderTiles((7.40, 43.72, 7.44, 43.75), 12, 16, 'tiles')\n\
+                {'tiles': 105, 'unique': 61, 'duplicates': 44, 'bytes': 5230412}\n\n"
+            "Args:\n\
+                bbox (tuple): (min_lon, min_lat, max_lon, max_lat) in degrees.\n\
+                min_zoom (int): First zoom level, at least 12.\n\
+                max_zoom (int): Last zoom level, at most 19.\n\
+                path (string): Output directory, or archive file.\n\
+                format (string 'directory' | 'archive'): 'directory' writes {path}/{z}/{x}/{y}.mvt, \
+                    'archive' writes one indexed file, see the README for its layout. (default 'directory')\n\n"
+            "Returns:\n\
+                (dict): The number of tiles, of distinct tiles written, of duplicates stored as references \
+                    (in practice the empty tiles), and the bytes of tile data written.\n\n"
+            "Raises:\n\
+                ValueError: On an invalid bbox or zoom range.\n\
+                RuntimeError: On a tile that can not be rendered or written."
+            )
+        .def("MatchSession", [](OSRMHandle* t, std::optional<MatchParameters> match_params, std::size_t window, std::size_t overlap) {
+            const MatchParameters options = match_params ? *match_params : MatchParameters();
+            return new osrm_nb_util::MatchSession(t->session_engine(), options, window, overlap);
+    }, nb::arg("match_params") = nb::none(), nb::arg("window") = 100, nb::arg("overlap") = 20,
+       nb::keep_alive<0, 1>(), nb::rv_policy::take_ownership,
+            "Creates a stateful matcher that accepts a trace incrementally and matches it over a sliding window.\n\n"
+            "Examples:\n\
+                >>> session = py_osrm.MatchSession(osrm.MatchParameters(annotations = ['nodes']), window = 100, overlap = 20)\n\
+                >>> res = session.Push(coordinates, timestamps = timestamps)\n\n"
+            "Args:\n\
+                match_params (osrm.MatchParameters): Optional settings shared by every window (exclude, snapping, steps, annotations, \
+                    geometries, overview, gaps, tidy), its per-coordinate fields are ignored. (default None)\n\
+                window (int): Points per Match request, at most max_locations_map_matching. (default 100)\n\
+                overlap (int): Trailing points of a window that are matched again with the next one, \
+                    so that points are only final once they have future context. (default 20)\n\n"
+            "Returns:\n\
+                (osrm.MatchSession): A session holding at most one window of points, regardless of the trace length.\n\n"
+            "Raises:\n\
+                ValueError: If window does not exceed overlap by at least 2."
+            )
+        .def("CacheStats", [](OSRMHandle* t) {
+            nb::dict stats;
+            const auto counters = t->cache_stats();
+            stats["enabled"] = t->cache() != nullptr;
+            stats["hits"] = counters.hits;
+            stats["misses"] = counters.misses;
+            stats["evictions"] = counters.evictions;
+            stats["entries"] = counters.entries;
+            stats["bytes"] = counters.bytes;
+            return stats;
+    }, "Returns the counters of the response cache.\n\n"
+            "Examples:\n\
+                >>> py_osrm.CacheStats()\n\
+                {'enabled': True, 'hits': 12, 'misses': 3, 'evictions': 0, 'entries': 3, 'bytes': 18432}\n\n"
+            "Returns:\n\
+                (dict): Whether caching is enabled, hit/miss/eviction counts since construction, \
+                    and the current number of entries and their approximate size in bytes. \
+                    For a profile of an osrm.Router, the counts are those of the shared cache and the entries those of the profile."
+            )
+        .def("ClearCache", [](OSRMHandle* t) {
+            t->clear_cache();
+    }, "Drops every entry of the response cache, the counters are kept.")
+        .def("SnapCacheStats", [](OSRMHandle* t) {
+            nb::dict stats;
+            std::shared_ptr<osrm_nb_util::HintCache> cache = t->hint_cache();
+            const auto counters = cache ? cache->stats() : osrm_nb_util::HintCache::Stats();
+            stats["enabled"] = cache != nullptr;
+            stats["hits"] = counters.hits;
+            stats["misses"] = counters.misses;
+            stats["evictions"] = counters.evictions;
+            stats["entries"] = counters.entries;
+            return stats;
+    }, "Returns the counters of the snap cache.\n\n"
+            "Examples:\n\
+                >>> py_osrm.SnapCacheStats()\n\
+                {'enabled': True, 'hits': 198, 'misses': 2, 'evictions': 0, 'entries': 2}\n\n"
+            "Returns:\n\
+                (dict): Whether the snap cache is enabled, hit/miss/eviction counts per coordinate since construction \
+                    or the latest Swap, and the current number of cached hints."
+            )
+        .def("ClearSnapCache", [](OSRMHandle* t) {
+            if(std::shared_ptr<osrm_nb_util::HintCache> cache = t->hint_cache()) {
+                cache->clear();
+            }
+    }, "Drops every cached hint, the counters are kept.")
+        .def("Stats", [](OSRMHandle* t) {
+            return stats_to_py(*t);
+    }, "Returns the request counters and per-phase latency histograms of every service.\n\n"
+            "Examples:\n\
+                >>> py_osrm.Stats()['route']['engine']\n\
+                {'count': 120, 'mean': 0.0004, 'p50': 0.00035, 'p90': 0.00061, 'p99': 0.0012, 'p999': 0.0015, 'max': 0.0015}\n\n"
+            "Returns:\n\
+                (dict): Per service ('match', 'nearest', 'route', 'table', 'trip', 'tile'), the number of 'requests', \
+                    their status 'codes', and a summary of the 'build' (parameter construction, process-wide), 'validation', \
+                    'engine' (including the caches), 'conversion' (into the output type) phases in seconds \
+                    and of the 'response_size' in bytes (approximate for dict and object outputs). \
+                    Quantiles are accurate to 12.5%. The batch and bulk services are not recorded. \
+                    'swap' summarizes the durations of Swap in seconds."
+            )
+        .def("ResetStats", [](OSRMHandle* t) {
+            t->stats().reset();
+    }, "Zeroes every counter and histogram reported by Stats.")
+        .def("StatsPrometheus", [](OSRMHandle* t) {
+            return t->stats().prometheus();
+    }, "Returns the counters of Stats in the Prometheus text exposition format.\n\n"
+            "Examples:\n\
+                >>> print(py_osrm.StatsPrometheus())\n\
+                osrm_requests_total{service=\"route\",code=\"Ok\"} 120\n\
+                osrm_phase_seconds{service=\"route\",phase=\"engine\",quantile=\"0.5\"} 0.00035\n\n"
+            "Returns:\n\
+                (string): The osrm_requests_total counter, and the osrm_phase_seconds and osrm_response_bytes summaries."
+            )
+        .def("Warmup", [](OSRMHandle* t, bool huge_pages, bool lock) {
+            osrm_nb_util::WarmupReport report;
+            {
+                nb::gil_scoped_release release;
+                report = t->warmup({ huge_pages, lock });
+            }
+            return warmup_report_to_py(report);
+    }, nb::arg("huge_pages") = false, nb::arg("lock") = false,
+            "Pre-faults the dataset files in parallel on the worker pool, so that the first queries of an engine \
+            using them through use_mmap do not wait on disk reads.\n\n"
+            "Examples:\n\
+                >>> py_osrm.Warmup()\n\
+                {'bytes': 2832012, 'files': 19, 'seconds': 0.004, 'huge_pages': False, 'locked': False}\n\n"
+            "Args:\n\
+                huge_pages (bool): Asks for transparent huge pages on the warmed files, Linux only. (default False)\n\
+                lock (bool): Locks the files into memory with mlock until the next Warmup or the destruction of the OSRM object, \
+                    where RLIMIT_MEMLOCK allows it. (default False)\n\n"
+            "Returns:\n\
+                (dict): The 'bytes' and 'files' touched, the 'seconds' it took, and whether every file accepted \
+                    'huge_pages' and got 'locked'.\n\n"
+            "Raises:\n\
+                RuntimeError: When a dataset file can not be mapped."
+            )
+        .def("Swap", [](OSRMHandle* t, std::optional<std::string> storage_config, std::optional<std::string> dataset_name,
+                        bool warmup, double drain_timeout) {
+            if(!(drain_timeout >= 0)) {
+                throw std::invalid_argument("drain_timeout must not be negative");
+            }
+            SwapReport report;
+            {
+                nb::gil_scoped_release release;
+                report = t->swap(storage_config, dataset_name, warmup, drain_timeout);
+            }
+
+            nb::dict out;
+            out["seconds"] = report.seconds;
+            out["build_seconds"] = report.build_seconds;
+            out["drain_seconds"] = report.drain_seconds;
+            out["drained"] = report.drained;
+            return out;
+    }, nb::arg("storage_config") = nb::none(), nb::arg("dataset_name") = nb::none(), nb::arg("warmup") = false,
+       nb::arg("drain_timeout") = 60.0,
+            "Replaces the dataset of this OSRM object without interrupting its requests.\n\n"
+            "A new engine is built with the current configuration and the given storage_config or dataset_name, \
+            while requests keep running on the old one. The new engine is then published atomically with an empty snap cache, \
+            the responses of the old dataset are no longer served from the cache, and the old engine is freed once the requests \
+            still running on it finished. \
+            Requests never wait on a swap, run it from another thread to keep serving meanwhile.\n\n"
+            "Examples:\n\
+                >>> await asyncio.to_thread(py_osrm.Swap, storage_config = 'monaco-2024-06.osrm')\n\
+                {'seconds': 0.21, 'build_seconds': 0.2, 'drain_seconds': 0.01, 'drained': True}\n\n"
+            "Args:\n\
+                storage_config (string): Path of the new dataset. (default None, keeps the current one)\n\
+                dataset_name (string): Name of the new shared memory dataset. (default None, keeps the current one)\n\
+                warmup (bool): Runs Warmup on the new dataset before publishing it, with the warmup_huge_pages and warmup_lock \
+                    options of the constructor. (default False)\n\
+                drain_timeout (float): Seconds to wait for the requests on the old engine. Past it, the last of them frees the engine. \
+                    A MatchSession keeps using the engine it was created with, and is not waited for. (default 60.0)\n\n"
+            "Returns:\n\
+                (dict): The 'seconds' of the whole swap, split into 'build_seconds' and 'drain_seconds', \
+                    and whether the old engine 'drained' within drain_timeout.\n\n"
+            "Raises:\n\
+                RuntimeError: When the new configuration is invalid or its engine fails to load, the current engine is kept then.\n\
+                ValueError: On a negative drain_timeout."
+            )
+        .def_static("ComparePresets", [](const std::string& storage_config, const std::vector<std::string>& presets, const nb::kwargs& kwargs) {
+            EngineConfig config;
+            osrm_nb_util::populate_cfg_from_kwargs(kwargs, config);
+            osrm_nb_util::set_disabled_features(config, storage_config, {});
+            if(!config.IsValid()) {
+                throw std::runtime_error("Config Parameters are Invalid");
+            }
+
+            std::vector<osrm_nb_util::PresetReport> reports;
+            {
+                nb::gil_scoped_release release;
+                reports = osrm_nb_util::compare_feature_presets(config, storage_config, presets);
+            }
+
+            nb::dict out;
+            for(const auto& report : reports) {
+                nb::list disabled;
+                for(const auto dataset : report.disabled) {
+                    disabled.append(osrm_nb_util::feature_dataset_name(dataset));
+                }
+                nb::dict entry;
+                entry["disabled"] = disabled;
+                entry["resident_bytes"] = report.resident_bytes;
+                entry["saved_bytes"] = report.saved_bytes;
+                entry["load_seconds"] = report.load_seconds;
+                out[report.preset.c_str()] = entry;
+            }
+            return out;
+    }, nb::arg("storage_config"), nb::arg("presets") = std::vector<std::string>{ "full", "table_only", "nearest_only" }, nb::arg("kwargs"),
+            "Measures the resident memory each feature preset saves on a dataset.\n\n"
+            "Every preset is loaded in turn into process memory, without mmap or shared memory so that all of its data is resident, \
+            and the growth of the resident set is compared with that of the full preset. Only one engine exists at a time.\n\n"
+            "Examples:\n\
+                >>> osrm.OSRM.ComparePresets('./tests/test_data/ch/monaco.osrm')\n\
+                {'full': {'disabled': [], 'resident_bytes': 9437184, 'saved_bytes': 0, 'load_seconds': 0.05}, \
+                    'table_only': {'disabled': ['ROUTE_STEPS', 'ROUTE_GEOMETRY'], 'resident_bytes': 5242880, ...}, ...}\n\n"
+            "Args:\n\
+                storage_config (string): Path of the dataset.\n\
+                presets (list of 'full' | 'table_only' | 'nearest_only'): Presets to measure. (default all)\n\
+                EngineConfig (osrm.osrm_ext.EngineConfig): Keyword arguments from the EngineConfig class, such as algorithm.\n\n"
+            "Returns:\n\
+                (dict): Per preset, the 'disabled' feature datasets, the 'resident_bytes' its engine added, \
+                    the 'saved_bytes' compared with the full preset, and its 'load_seconds'.\n\n"
+            "Raises:\n\
+                RuntimeError: On invalid EngineConfig parameters.\n\
+                ValueError: On an unknown preset."
+            )
+        .def("LastWarmup", [](OSRMHandle* t) -> nb::object {
+            if(auto report = t->last_warmup()) {
+                return warmup_report_to_py(*report);
+            }
+            return nb::none();
+    }, "Returns the report of the latest Warmup, including the one run by the constructor with warmup = True, \
+            or None when none ran.")
+        .def("RouteMany", &run_many<RouteParameters>, "Runs many Route requests concurrently on the worker pool.\n\n"
+            "Examples:\n\
+                >>> results, codes = py_osrm.RouteMany([route_params_a, route_params_b])\n\n"
+            "Args:\n\
+                params (list of osrm.RouteParameters): RouteParameters Objects.\n\n"
+            "Returns:\n\
+                (tuple): A list of Route JSON Responses, and a list of their status codes ('Ok' on success). \
+                    Failed requests do not raise, their response holds the error code and message instead."
+            )
+        .def("TableMany", &run_many<TableParameters>, "Runs many Table requests concurrently on the worker pool.\n\n"
+            "Examples:\n\
+                >>> results, codes = py_osrm.TableMany([table_params_a, table_params_b])\n\n"
+            "Args:\n\
+                params (list of osrm.TableParameters): TableParameters Objects.\n\n"
+            "Returns:\n\
+                (tuple): A list of Table JSON Responses, and a list of their status codes ('Ok' on success). \
+                    Failed requests do not raise, their response holds the error code and message instead."
+            )
+        .def("NearestMany", &run_many<NearestParameters>, "Runs many Nearest requests concurrently on the worker pool.\n\n"
+            "Examples:\n\
+                >>> results, codes = py_osrm.NearestMany([nearest_params_a, nearest_params_b])\n\n"
+            "Args:\n\
+                params (list of osrm.NearestParameters): NearestParameters Objects.\n\n"
+            "Returns:\n\
+                (tuple): A list of Nearest JSON Responses, and a list of their status codes ('Ok' on success). \
+                    Failed requests do not raise, their response holds the error code and message instead."
+            )
+        .def("NearestBulk", [](OSRMHandle* t,
+                               nb::handle coordinates,
+                               std::size_t number_of_results,
+                               nb::handle radiuses,
+                               nb::handle bearings,
+                               std::optional<NearestParameters> nearest_params) {
+            const auto points = osrm_nb_util::to_coordinates(coordinates);
+            const auto point_radiuses = radiuses.is_none() ? std::vector<std::optional<double>>() : osrm_nb_util::to_radiuses(radiuses);
+            const auto point_bearings = bearings.is_none() ? std::vector<std::optional<osrm::engine::Bearing>>() : osrm_nb_util::to_bearings(bearings);
+            if(!point_radiuses.empty() && point_radiuses.size() != points.size()) {
+                throw std::invalid_argument("radiuses must have one entry per coordinate");
+            }
+            if(!point_bearings.empty() && point_bearings.size() != points.size()) {
+                throw std::invalid_argument("bearings must have one entry per coordinate");
+            }
+            const NearestParameters options = nearest_params ? *nearest_params : NearestParameters();
+
+            osrm_nb_util::NearestArrays arrays;
+            {
+                nb::gil_scoped_release release;
+                arrays = osrm_nb_util::run_nearest_bulk(*t->engine(), t->pool(), options, points, point_radiuses, point_bearings, number_of_results);
+            }
+            return osrm_nb_util::nearest_arrays_to_py(std::move(arrays));
+    }, nb::arg("coordinates"), nb::arg("number_of_results") = 1, nb::arg("radiuses") = nb::none(),
+       nb::arg("bearings") = nb::none(), nb::arg("nearest_params") = nb::none(),
+            "Snaps many coordinates at once on the worker pool and returns the results as NumPy columns.\n\n"
+            "Examples:\n\
+                >>> res = py_osrm.NearestBulk(np.array([[7.41337, 43.72956], [7.41546, 43.73077]]))\n\
+                >>> res['lon'], res['lat'], res['distance']\n\
+                >>> res = py_osrm.NearestBulk(probes, number_of_results = 3)\n\
+                >>> res['distance'].shape\n\
+                (1000000, 3)\n\n"
+            "Args:\n\
+                coordinates (numpy.ndarray or list): (N, 2) longitude/latitude pairs, float64 degrees or int32 fixed-point.\n\
+                number_of_results (int): Number of nearest results k per point. (default 1)\n\
+                radiuses (numpy.ndarray or list): Optional (N,) search radius per point in meters, NaN for unlimited. (default None)\n\
+                bearings (numpy.ndarray or list): Optional (N, 2) bearing/range per point, a negative bearing for none. (default None)\n\
+                nearest_params (osrm.NearestParameters): Optional options shared by every point (exclude, snapping), \
+                    its coordinates are ignored. (default None)\n\n"
+            "Returns:\n\
+                (dict): 'lon', 'lat', 'distance' (float64) and 'name' (int32 index into 'names', -1 for none) shaped (N,), \
+                    or (N, k) when number_of_results > 1, 'nodes' (uint64) shaped (N, 2) or (N, k, 2), \
+                    and 'status' (uint8, (N,)) indexing 'status_names': Ok, NoSegment, InvalidValue, InvalidOptions, Error. \
+                    Points that fail, or results missing for a point, are NaN / -1 / 0 instead of raising.\n\n"
+            "Raises:\n\
+                ValueError: On malformed coordinates, radiuses or bearings arrays."
+            )
+        .def("TripBulk", [](OSRMHandle* t,
+                            nb::handle trips,
+                            nb::handle offsets,
+                            std::optional<TripParameters> trip_params,
+                            bool full_json) {
+            std::vector<TripParameters> params;
+            if(offsets.is_none()) {
+                params = nb::cast<std::vector<TripParameters>>(trips);
+            } else {
+                const auto coordinates = osrm_nb_util::to_coordinates(trips);
+                const auto bounds = osrm_nb_util::to_indices(offsets, "offsets");
+                if(bounds.empty() || bounds.front() != 0 || bounds.back() != coordinates.size() ||
+                   !std::is_sorted(bounds.begin(), bounds.end())) {
+                    throw std::invalid_argument("offsets must rise from 0 to the number of coordinates");
+                }
+
+                // Only the shared settings of the template apply, the coordinates come from the array
+                TripParameters options = trip_params ? *trip_params : TripParameters();
+                options.coordinates.clear();
+                options.hints.clear();
+                options.radiuses.clear();
+                options.bearings.clear();
+                options.approaches.clear();
+
+                params.resize(bounds.size() - 1, options);
+                for(std::size_t k = 0; k + 1 < bounds.size(); ++k) {
+                    params[k].coordinates.assign(coordinates.begin() + bounds[k], coordinates.begin() + bounds[k + 1]);
+                }
+            }
+
+            osrm_nb_util::TripBulk bulk;
+            {
+                nb::gil_scoped_release release;
+                const EnginePin pin = t->pin();
+                bulk = osrm_nb_util::run_trip_bulk(*pin.engine, t->pool(), params, full_json, pin.hints);
+            }
+
+            nb::dict out = osrm_nb_util::trip_arrays_to_py(std::move(bulk.arrays));
+            nb::list codes;
+            for(const auto& code : bulk.codes) {
+                codes.append(nb::str(code.c_str(), code.size()));
+            }
+            out["codes"] = codes;
+
+            if(full_json) {
+                nb::list responses;
+                for(const auto& result : bulk.results) {
+                    responses.append(json_object_to_py(result));
+                }
+                out["responses"] = responses;
+            } else {
+                out["responses"] = nb::none();
+            }
+            return out;
+    }, nb::arg("trips"), nb::arg("offsets") = nb::none(), nb::arg("trip_params") = nb::none(), nb::arg("full_json") = false,
+            "Solves many Trip requests concurrently on the worker pool and returns their solutions as NumPy arrays.\n\n"
+            "Examples:\n\
+                >>> res = py_osrm.TripBulk([trip_params_a, trip_params_b])\n\
+                >>> res = py_osrm.TripBulk(stops, offsets = np.array([0, 12, 30]), trip_params = osrm.TripParameters(roundtrip = True))\n\
+                >>> res['permutation'][res['offsets'][1]:res['offsets'][2]]\n\n"
+            "Args:\n\
+                trips (list of osrm.TripParameters | numpy.ndarray): TripParameters Objects, \
+                    or the (M, 2) coordinates of all trips back to back when offsets is given.\n\
+                offsets (numpy.ndarray or list): Optional (K + 1,) start of every trip in trips, ending with M. (default None)\n\
+                trip_params (osrm.TripParameters): Settings shared by the trips of a coordinate array (roundtrip, source, destination, \
+                    exclude, ...), its coordinates are ignored. (default None)\n\
+                full_json (bool): Also return the complete Trip JSON Responses, with geometry. (default False)\n\n"
+            "Returns:\n\
+                (dict): 'offsets' (int64, (K + 1,)) and 'permutation' (int64), where the slice of trip k lists its input \
+                    indices in visiting order (-1 for a failed request), 'duration' and 'distance' (float64, (K,), NaN on failure), \
+                    'num_trips' (uint32, (K,), more than 1 when the coordinates span disconnected components), \
+                    'codes' ('Ok' on success) and 'responses' (the JSON Responses, or None). Failed requests do not raise."
+            )
+        .def("MatchAsync", [](nb::pointer_and_handle<OSRMHandle> self, const MatchParameters& params, const std::string& output,
+                              nb::handle coordinates, nb::handle hints, nb::handle radiuses, nb::handle timestamps) {
+            return run_service_async(self, params, output, to_overrides(coordinates, hints, radiuses, timestamps));
+    }, nb::arg("match_params"), nb::arg("output") = "dict",
+       nb::arg("coordinates") = nb::none(), nb::arg("hints") = nb::none(), nb::arg("radiuses") = nb::none(),
+       nb::arg("timestamps") = nb::none(),
+            "Awaitable version of Match, the request runs on the worker pool without blocking the event loop.\n\n"
+            "Examples:\n\
+                >>> res = await py_osrm.MatchAsync(match_params)\n\n"
+            "Args:\n\
+                match_params (osrm.MatchParameters): MatchParameters Object.\n\
+                output (string 'dict' | 'object' | 'bytes' | 'numpy'): Same as in Match. (default 'dict')\n\
+                coordinates, hints, radiuses, timestamps: Same as in Match. (default None)\n\n"
+            "Returns:\n\
+                (asyncio.Future): Resolves to the same response as Match.\n\n"
+            "Raises:\n\
+                RuntimeError: On invalid MatchParameters, or when called outside of a running event loop."
+            )
+        .def("NearestAsync", [](nb::pointer_and_handle<OSRMHandle> self, const NearestParameters& params, const std::string& output,
+                                nb::handle coordinates, nb::handle hints, nb::handle radiuses) {
+            return run_service_async(self, params, output, to_overrides(coordinates, hints, radiuses));
+    }, nb::arg("nearest_params"), nb::arg("output") = "dict",
+       nb::arg("coordinates") = nb::none(), nb::arg("hints") = nb::none(), nb::arg("radiuses") = nb::none(),
+            "Awaitable version of Nearest, the request runs on the worker pool without blocking the event loop.\n\n"
+            "Examples:\n\
+                >>> res = await py_osrm.NearestAsync(nearest_params)\n\n"
+            "Args:\n\
+                nearest_params (osrm.NearestParameters): NearestParameters Object.\n\
+                output (string 'dict' | 'object' | 'bytes'): Same as in Nearest. (default 'dict')\n\
+                coordinates, hints, radiuses: Same as in Nearest. (default None)\n\n"
+            "Returns:\n\
+                (asyncio.Future): Resolves to the same response as Nearest.\n\n"
+            "Raises:\n\
+                RuntimeError: On invalid NearestParameters, or when called outside of a running event loop."
+            )
+        .def("RouteAsync", [](nb::pointer_and_handle<OSRMHandle> self, const RouteParameters& params, const std::string& output,
+                              nb::handle coordinates, nb::handle hints, nb::handle radiuses) {
+            return run_service_async(self, params, output, to_overrides(coordinates, hints, radiuses));
+    }, nb::arg("route_params"), nb::arg("output") = "dict",
+       nb::arg("coordinates") = nb::none(), nb::arg("hints") = nb::none(), nb::arg("radiuses") = nb::none(),
+            "Awaitable version of Route, the request runs on the worker pool without blocking the event loop.\n\n"
+            "Examples:\n\
+                >>> res = await py_osrm.RouteAsync(route_params)\n\n"
+            "Args:\n\
+                route_params (osrm.RouteParameters): RouteParameters Object.\n\
+                output (string 'dict' | 'object' | 'bytes' | 'numpy'): Same as in Route. (default 'dict')\n\
+                coordinates, hints, radiuses: Same as in Route. (default None)\n\n"
+            "Returns:\n\
+                (asyncio.Future): Resolves to the same response as Route.\n\n"
+            "Raises:\n\
+                RuntimeError: On invalid RouteParameters, or when called outside of a running event loop."
+            )
+        .def("TableAsync", [](nb::pointer_and_handle<OSRMHandle> self, const TableParameters& params, const std::string& output,
+                              nb::handle coordinates, nb::handle hints, nb::handle radiuses) {
+            return run_service_async(self, params, output, to_overrides(coordinates, hints, radiuses));
+    }, nb::arg("table_params"), nb::arg("output") = "dict",
+       nb::arg("coordinates") = nb::none(), nb::arg("hints") = nb::none(), nb::arg("radiuses") = nb::none(),
+            "Awaitable version of Table, the request runs on the worker pool without blocking the event loop.\n\n"
+            "Examples:\n\
+                >>> res = await py_osrm.TableAsync(table_params)\n\n"
+            "Args:\n\
+                table_params (osrm.TableParameters): TableParameters Object.\n\
+                output (string 'dict' | 'object' | 'bytes' | 'numpy'): Same as in Table. (default 'dict')\n\
+                coordinates, hints, radiuses: Same as in Table. (default None)\n\n"
+            "Returns:\n\
+                (asyncio.Future): Resolves to the same response as Table.\n\n"
+            "Raises:\n\
+                RuntimeError: On invalid TableParameters, or when called outside of a running event loop."
+            )
+        .def("TileAsync", [](nb::pointer_and_handle<OSRMHandle> self, const TileParameters& params) {
+            osrm_nb_util::ServiceStats& stats = self.p->stats().service(osrm_nb_util::StatsService::Tile);
+            auto snapshot = std::make_shared<const TileParameters>(snapshot_parameters(params));
+            validate_tile(stats, *snapshot);
+
+            std::shared_ptr<const osrm::OSRM> engine = self.p->engine();
+            return self.p->executor().submit(self.h, [engine, &stats, snapshot] {
+                auto result = std::make_shared<std::string>();
+                {
+                    osrm_nb_util::ScopedTimer timer(stats.phase(osrm_nb_util::Phase::Engine));
+                    record_tile(stats, engine->Tile(*snapshot, *result), *result);
+                }
+                return osrm_nb_util::AsyncExecutor::Finisher([result] {
+                    return nb::cast(Buffer::from_string(std::move(*result)));
+                });
+            });
+    }, nb::arg("tile_params"),
+            "Awaitable version of Tile, the request runs on the worker pool without blocking the event loop.\n\n"
+            "Examples:\n\
+                >>> res = await py_osrm.TileAsync(tile_params)\n\n"
+            "Args:\n\
+                tile_params (osrm.TileParameters): TileParameters Object.\n\n"
+            "Returns:\n\
+                (asyncio.Future): Resolves to the same response as Tile.\n\n"
+            "Raises:\n\
+                RuntimeError: On invalid TileParameters, or when called outside of a running event loop."
+            )
+        .def("TripAsync", [](nb::pointer_and_handle<OSRMHandle> self, const TripParameters& params, const std::string& output,
+                             nb::handle coordinates, nb::handle hints, nb::handle radiuses) {
+            return run_service_async(self, params, output, to_overrides(coordinates, hints, radiuses));
+    }, nb::arg("trip_params"), nb::arg("output") = "dict",
+       nb::arg("coordinates") = nb::none(), nb::arg("hints") = nb::none(), nb::arg("radiuses") = nb::none(),
+            "Awaitable version of Trip, the request runs on the worker pool without blocking the event loop.\n\n"
+            "Examples:\n\
+                >>> res = await py_osrm.TripAsync(trip_params)\n\n"
+            "Args:\n\
+                trip_params (osrm.TripParameters): TripParameters Object.\n\
+                output (string 'dict' | 'object' | 'bytes'): Same as in Trip. (default 'dict')\n\
+                coordinates, hints, radiuses: Same as in Trip. (default None)\n\n"
+            "Returns:\n\
+                (asyncio.Future): Resolves to the same response as Trip.\n\n"
+            "Raises:\n\
+                RuntimeError: On invalid TripParameters, or when called outside of a running event loop."
+            );
+
+    nb::class_<Router>(m, "Router", nb::is_final(),
+            "Several datasets, one per profile (car, bicycle, foot, ...), behind one object.\n\n"
+            "Every profile is a full osrm.OSRM object, available as router[profile], with its own engine, snap cache, \
+            statistics and Swap. The profiles share one worker pool and one response cache budget.\n\n"
+            "Examples:\n\
+                >>> router = osrm.Router(\n\
+                        {'car': 'car/monaco.osrm', 'foot': {'storage_config': 'foot/monaco.osrm', 'algorithm': 'MLD'}},\n\
+                        use_shared_memory = False,\n\
+                        num_threads = 8,\n\
+                        cache_max_bytes = 256 << 20\n\
+                    )\n\
+                >>> res = router.Route('foot', route_params)\n\
+                >>> res = await router['car'].TableAsync(table_params)\n\n"
+            "Args:\n\
+                profiles (dict): Profile name to the storage_config path of its dataset, or to a dict of EngineConfig keyword arguments. \
+                    A path alone implies use_shared_memory = False.\n\
+                num_threads, max_in_flight, cache_max_entries, cache_max_bytes: Same as in osrm.OSRM, shared by all profiles, \
+                    except max_in_flight which applies per profile.\n\
+                snap_cache_entries, warmup, warmup_huge_pages, warmup_lock: Same as in osrm.OSRM, per profile.\n\
+                EngineConfig (osrm.osrm_ext.EngineConfig): Keyword arguments applied to every profile, unless the profile sets them.\n\n"
+            "Raises:\n\
+                RuntimeError: On invalid EngineConfig parameters of a profile.\n\
+                ValueError: Without profiles."
+            )
+        .def("__init__", [](Router* t, const nb::dict& profiles, const nb::kwargs& kwargs) {
+            HandleOptions options;
+            nb::dict shared_kwargs;
+            for(auto kwarg : kwargs) {
+                if(!set_handle_option(options, nb::cast<std::string>(kwarg.first), kwarg.second)) {
+                    shared_kwargs[kwarg.first] = kwarg.second;
+                }
+            }
+            if(profiles.size() == 0) {
+                throw std::invalid_argument("A Router needs at least one profile");
+            }
+
+            std::vector<std::pair<std::string, EngineConfig>> configs;
+            for(auto profile : profiles) {
+                const std::string name = nb::cast<std::string>(profile.first);
+                nb::dict cfg_kwargs;
+                for(auto kwarg : shared_kwargs) {
+                    cfg_kwargs[kwarg.first] = kwarg.second;
+                }
+                if(nb::isinstance<nb::str>(profile.second)) {
+                    cfg_kwargs["storage_config"] = profile.second;
+                    if(!cfg_kwargs.contains("use_shared_memory")) {
+                        cfg_kwargs["use_shared_memory"] = false;
+                    }
+                } else {
+                    for(auto kwarg : nb::cast<nb::dict>(profile.second)) {
+                        cfg_kwargs[kwarg.first] = kwarg.second;
+                    }
+                }
+
+                EngineConfig config;
+                osrm_nb_util::populate_cfg_from_kwargs(cfg_kwargs, config);
+                if(!config.IsValid()) {
+                    throw std::runtime_error("Config Parameters of profile " + name + " are Invalid");
+                }
+                configs.emplace_back(name, std::move(config));
+            }
+
+            new (t) Router(configs, options);
+            if(options.warmup) {
+                try {
+                    nb::gil_scoped_release release;
+                    for(const std::string& name : t->names()) {
+                        t->profile(name)->warmup({ options.warmup_huge_pages, options.warmup_lock });
+                    }
+                }
+                catch(...) {
+                    // nanobind only destroys objects whose __init__ succeeded
+                    t->~Router();
+                    throw;
+                }
+            }
+    }, nb::arg("profiles"), nb::arg("kwargs"))
+        .def("__getitem__", [](Router* t, const std::string& name) -> OSRMHandle& {
+            return router_profile(*t, name);
+    }, nb::arg("profile"), nb::rv_policy::reference_internal, "Returns the osrm.OSRM object of a profile.")
+        .def("__contains__", [](Router* t, const std::string& name) {
+            return t->profile(name) != nullptr;
+    }, nb::arg("profile"))
+        .def("__len__", [](Router* t) {
+            return t->names().size();
+    })
+        .def("Profiles", &Router::names, "Returns the profile names in sorted order.")
+        .def("Match", [](Router* t, const std::string& profile, const MatchParameters& params, const std::string& output,
+                         nb::handle coordinates, nb::handle hints, nb::handle radiuses, nb::handle timestamps) {
+            return run_service(router_profile(*t, profile), params, osrm_nb_util::str_to_enum(output, "Output", output_type_map),
+                               to_overrides(coordinates, hints, radiuses, timestamps));
+    }, nb::arg("profile"), nb::arg("match_params"), nb::arg("output") = "dict",
+       nb::arg("coordinates") = nb::none(), nb::arg("hints") = nb::none(), nb::arg("radiuses") = nb::none(),
+       nb::arg("timestamps") = nb::none(),
+            "Runs Match on the dataset of profile, the other arguments are the same as in osrm.OSRM.Match.\n\n"
+            "Raises:\n\
+                KeyError: On an unknown profile."
+            )
+        .def("Nearest", [](Router* t, const std::string& profile, const NearestParameters& params, const std::string& output,
+                           nb::handle coordinates, nb::handle hints, nb::handle radiuses) {
+            return run_service(router_profile(*t, profile), params, osrm_nb_util::str_to_enum(output, "Output", output_type_map),
+                               to_overrides(coordinates, hints, radiuses));
+    }, nb::arg("profile"), nb::arg("nearest_params"), nb::arg("output") = "dict",
+       nb::arg("coordinates") = nb::none(), nb::arg("hints") = nb::none(), nb::arg("radiuses") = nb::none(),
+            "Runs Nearest on the dataset of profile, the other arguments are the same as in osrm.OSRM.Nearest.\n\n"
+            "Raises:\n\
+                KeyError: On an unknown profile."
+            )
+        .def("Route", [](Router* t, const std::string& profile, const RouteParameters& params, const std::string& output,
+                         nb::handle coordinates, nb::handle hints, nb::handle radiuses) {
+            return run_service(router_profile(*t, profile), params, osrm_nb_util::str_to_enum(output, "Output", output_type_map),
+                               to_overrides(coordinates, hints, radiuses));
+    }, nb::arg("profile"), nb::arg("route_params"), nb::arg("output") = "dict",
+       nb::arg("coordinates") = nb::none(), nb::arg("hints") = nb::none(), nb::arg("radiuses") = nb::none(),
+            "Runs Route on the dataset of profile, the other arguments are the same as in osrm.OSRM.Route.\n\n"
+            "Raises:\n\
+                KeyError: On an unknown profile."
+            )
+        .def("Table", [](Router* t, const std::string& profile, const TableParameters& params, const std::string& output,
+                         nb::handle coordinates, nb::handle hints, nb::handle radiuses) {
+            return run_service(router_profile(*t, profile), params, osrm_nb_util::str_to_enum(output, "Output", output_type_map),
+                               to_overrides(coordinates, hints, radiuses));
+    }, nb::arg("profile"), nb::arg("table_params"), nb::arg("output") = "dict",
+       nb::arg("coordinates") = nb::none(), nb::arg("hints") = nb::none(), nb::arg("radiuses") = nb::none(),
+            "Runs Table on the dataset of profile, the other arguments are the same as in osrm.OSRM.Table.\n\n"
+            "Raises:\n\
+                KeyError: On an unknown profile."
+            )
+        .def("Trip", [](Router* t, const std::string& profile, const TripParameters& params, const std::string& output,
+                        nb::handle coordinates, nb::handle hints, nb::handle radiuses) {
+            return run_service(router_profile(*t, profile), params, osrm_nb_util::str_to_enum(output, "Output", output_type_map),
+                               to_overrides(coordinates, hints, radiuses));
+    }, nb::arg("profile"), nb::arg("trip_params"), nb::arg("output") = "dict",
+       nb::arg("coordinates") = nb::none(), nb::arg("hints") = nb::none(), nb::arg("radiuses") = nb::none(),
+            "Runs Trip on the dataset of profile, the other arguments are the same as in osrm.OSRM.Trip.\n\n"
+            "Raises:\n\
+                KeyError: On an unknown profile."
+            )
+        .def("Stats", [](Router* t) {
+            nb::dict stats;
+            for(const std::string& name : t->names()) {
+                OSRMHandle& handle = *t->profile(name);
+                const auto cache = handle.cache_stats();
+
+                nb::dict memory;
+                memory["dataset_bytes"] = handle.dataset_bytes();
+                memory["cache_entries"] = cache.entries;
+                memory["cache_bytes"] = cache.bytes;
+
+                nb::dict entry = stats_to_py(handle);
+                entry["memory"] = memory;
+                stats[name.c_str()] = entry;
+            }
+            return stats;
+    }, "Returns the statistics of every profile.\n\n"
+            "Examples:\n\
+                >>> router.Stats()['car']['memory']\n\
+                {'dataset_bytes': 2832012, 'cache_entries': 120, 'cache_bytes': 1048576}\n\n"
+            "Returns:\n\
+                (dict): Per profile, the same statistics as osrm.OSRM.Stats, plus its 'memory': the size of its dataset files \
+                    (0 for shared memory), and the entries and approximate bytes it holds in the shared response cache."
             );
 }
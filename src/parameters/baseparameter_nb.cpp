@@ -1,10 +1,12 @@
 #include "parameters/baseparameter_nb.h"
 
 #include "engine/api/base_parameters.hpp"
+#include "utility/input_utility.h"
 #include "utility/param_utility.h"
 
 #include <nanobind/nanobind.h>
 #include <nanobind/stl/string.h>
+#include <nanobind/stl/optional.h>
 #include <nanobind/stl/vector.h>
 
 namespace nb = nanobind;
@@ -18,14 +20,17 @@ void init_BaseParameters(nb::module_& m) {
             "Note:\n\
                 This is the parent class to many parameter classes, and not intended to be used on its own.\n\n"
             "Args:\n\
-                coordinates (list of floats pairs): Pairs of Longitude and Latitude Coordinates. (default [])\n\
+                coordinates (list of floats pairs | numpy.ndarray): Pairs of Longitude and Latitude Coordinates, \
+                    or an (N, 2) float64 array in degrees / int32 array in fixed-point (degrees * 1e6). (default [])\n\
                 hints (list): Hint from previous request to derive position in street network. (default [])\n\
-                radiuses (list of floats): Limits the search to given radius in meters. (default [])\n\
-                bearings (list of int pairs): Limits the search to segments with given bearing in degrees towards true north in clockwise direction. (default [])\n\
+                radiuses (list of floats | numpy.ndarray): Limits the search to given radius in meters, NaN or None leaves it unset. (default [])\n\
+                bearings (list of int pairs | numpy.ndarray): Limits the search to segments with given bearing in degrees towards true north in clockwise direction. \
+                    An (N, 2) int16 array is also accepted, where a negative bearing leaves the entry unset. (default [])\n\
                 approaches (list): Keep waypoints on curb side. (default [])\n\
                 generate_hints (bool): Adds a hint to the response which can be used in subsequent requests. (default True)\n\
                 exclude (list of strings): Additive list of classes to avoid. (default [])\n\
-                snapping (string 'default' | 'any'): 'default' snapping avoids is_startpoint edges, 'any' will snap to any edge in the graph. (default '')\n\n"
+                snapping (string 'default' | 'any'): 'default' snapping avoids is_startpoint edges, 'any' will snap to any edge in the graph. (default '')\n\
+                format (string 'json' | 'flatbuffers'): Response format, 'flatbuffers' returns the serialized response as an osrm.Buffer. (default 'json')\n\n"
             "Returns:\n\
                 __init__ (py_osrm.osrm_ext.BaseParameters): A BaseParameter object, that is the parent object to many other Parameter objects.\n\
                 IsValid (bool): A bool value denoting validity of parameter values.\n\n"
@@ -36,21 +41,28 @@ void init_BaseParameters(nb::module_& m) {
                 bearings (list of int pairs): Limits the search to segments with given bearing in degrees towards true north in clockwise direction.\n\
                 approaches (list): Keep waypoints on curb side.\n\
                 exclude (list of strings): Additive list of classes to avoid, order does not matter.\n\
-                format (string): Specifies response type - currently only 'json' is supported.\n\
+                format (string): Specifies response type - 'json' or 'flatbuffers'.\n\
                 generate_hints (bool): Adds a hint to the response which can be used in subsequent requests.\n\
                 skip_waypoints (list): Removes waypoints from the response.\n\
                 snapping (string): 'default' snapping avoids is_startpoint edges, 'any' will snap to any edge in the graph."
             )
-        .def_rw("coordinates", &BaseParameters::coordinates)
-        .def_rw("hints", &BaseParameters::hints)
-        .def_rw("radiuses", &BaseParameters::radiuses)
-        .def_rw("bearings", &BaseParameters::bearings)
-        .def_rw("approaches", &BaseParameters::approaches)
-        .def_rw("exclude", &BaseParameters::exclude)
-        .def_rw("format", &BaseParameters::format)
-        .def_rw("generate_hints", &BaseParameters::generate_hints)
-        .def_rw("skip_waypoints", &BaseParameters::skip_waypoints)
-        .def_rw("snapping", &BaseParameters::snapping)
+        // Properties lock the object in free-threaded builds, requests copy it under the same lock
+        .def_prop_rw("coordinates",
+            [](const BaseParameters& p) { return p.coordinates; },
+            [](BaseParameters& p, nb::handle value) { p.coordinates = osrm_nb_util::to_coordinates(value); }, nb::lock_self())
+        .def_rw("hints", &BaseParameters::hints, nb::lock_self())
+        .def_prop_rw("radiuses",
+            [](const BaseParameters& p) { return p.radiuses; },
+            [](BaseParameters& p, nb::handle value) { p.radiuses = osrm_nb_util::to_radiuses(value); }, nb::lock_self())
+        .def_prop_rw("bearings",
+            [](const BaseParameters& p) { return p.bearings; },
+            [](BaseParameters& p, nb::handle value) { p.bearings = osrm_nb_util::to_bearings(value); }, nb::lock_self())
+        .def_rw("approaches", &BaseParameters::approaches, nb::lock_self())
+        .def_rw("exclude", &BaseParameters::exclude, nb::lock_self())
+        .def_rw("format", &BaseParameters::format, nb::lock_self())
+        .def_rw("generate_hints", &BaseParameters::generate_hints, nb::lock_self())
+        .def_rw("skip_waypoints", &BaseParameters::skip_waypoints, nb::lock_self())
+        .def_rw("snapping", &BaseParameters::snapping, nb::lock_self())
         .def("IsValid", &BaseParameters::IsValid);
 
     nb::enum_<BaseParameters::SnappingType>(m, "SnappingType")
@@ -1,7 +1,11 @@
 #include "parameters/matchparameter_nb.h"
+#include "parameters/baseparameter_nb.h"
 
 #include "engine/api/match_parameters.hpp"
+#include "utility/input_utility.h"
+#include "utility/param_key.h"
 #include "utility/param_utility.h"
+#include "utility/service_stats.h"
 #include "parameters/parse_helpers.h"
 
 #include <nanobind/nanobind.h>
@@ -28,7 +32,7 @@ void init_MatchParameters(nb::module_& m) {
                 >>> match_params.IsValid()\n\
                 True\n\n"
             "Args:\n\
-                timestamps (list of unsigned int): Timestamps for the input locations in seconds since UNIX epoch. (default [])\n\
+                timestamps (list of unsigned int | numpy.ndarray): Timestamps for the input locations in seconds since UNIX epoch. (default [])\n\
                 gaps ('split' | 'ignore'): Allows the input track splitting based on huge timestamp gaps between points. (default '')\n\
                 tidy (bool): Allows input track modification for noisy tracks. (default False)\n\
                 RouteParameters (osrm.RouteParameters): Keyword arguments from parent class.\n\n"
@@ -42,6 +46,7 @@ void init_MatchParameters(nb::module_& m) {
                 RouteParameters (osrm.RouteParameters): Attributes from parent class."
             )
         .def("__init__", [](MatchParameters* t, const nb::kwargs& kwargs){
+            osrm_nb_util::ScopedTimer build_timer(osrm_nb_util::build_histogram(osrm_nb_util::StatsService::Match));
             new (t) MatchParameters();
 
             // Inherited RouteParameters defaults (keep in sync with RouteParameters binding)
@@ -71,7 +76,7 @@ void init_MatchParameters(nb::module_& m) {
             for(auto item : kwargs){
                 std::string key = nb::cast<std::string>(item.first);
                 if(key=="timestamps") {
-                    for(nb::handle h : nb::iter(item.second)) timestamps.push_back(nb::cast<unsigned>(h));
+                    timestamps = osrm_nb_util::to_timestamps(item.second);
                 } else if(key=="gaps") {
                     if(nb::isinstance<nb::str>(item.second)) gaps_type = parse_gaps(nb::cast<std::string>(item.second));
                     else gaps_type = nb::cast<MatchParameters::GapsType>(item.second);
@@ -97,20 +102,10 @@ void init_MatchParameters(nb::module_& m) {
                     if(item.second.is_none()) continue_straight.reset(); else continue_straight = nb::cast<bool>(item.second);
                 }
                 else if(key=="waypoints") {
-                    for(nb::handle h : nb::iter(item.second)) waypoints.push_back(nb::cast<std::size_t>(h));
+                    waypoints = osrm_nb_util::to_indices(item.second, "waypoints");
                 }
                 else if(key=="coordinates") {
-                    for(nb::handle h : nb::iter(item.second)) {
-                        if(nb::isinstance<nb::tuple>(h)) {
-                            auto tup = nb::tuple(h);
-                            if(tup.size()!=2) throw std::runtime_error("Coordinate tuple must have length 2");
-                            double lon = nb::cast<double>(tup[0]);
-                            double lat = nb::cast<double>(tup[1]);
-                            coordinates.emplace_back(osrm::util::FloatLongitude{lon}, osrm::util::FloatLatitude{lat});
-                        } else {
-                            coordinates.push_back(nb::cast<osrm::util::Coordinate>(h));
-                        }
-                    }
+                    coordinates = osrm_nb_util::to_coordinates(item.second);
                 }
                 else if(key=="exclude") {
                     for(nb::handle h : nb::iter(item.second)) exclude.push_back(nb::cast<std::string>(h));
@@ -120,16 +115,18 @@ void init_MatchParameters(nb::module_& m) {
                     if(nb::isinstance<nb::str>(item.second)) snapping = parse_snapping(nb::cast<std::string>(item.second));
                     else snapping = nb::cast<BaseParameters::SnappingType>(item.second);
                 }
+                else if(key=="format") {
+                    if(nb::isinstance<nb::str>(item.second)) t->format = parse_output_format(nb::cast<std::string>(item.second));
+                    else t->format = nb::cast<BaseParameters::OutputFormatType>(item.second);
+                }
                 else if(key=="hints") {
                     for(nb::handle h : nb::iter(item.second)) hints.push_back(nb::cast<std::optional<osrm::engine::Hint>>(h));
                 }
                 else if(key=="radiuses") {
-                    for(nb::handle h : nb::iter(item.second)) {
-                        if(h.is_none()) radiuses.push_back(std::optional<double>()); else radiuses.push_back(nb::cast<double>(h));
-                    }
+                    radiuses = osrm_nb_util::to_radiuses(item.second);
                 }
                 else if(key=="bearings") {
-                    for(nb::handle h : nb::iter(item.second)) bearings.push_back(nb::cast<std::optional<osrm::engine::Bearing>>(h));
+                    bearings = osrm_nb_util::to_bearings(item.second);
                 }
                 else if(key=="approaches") {
                     for(nb::handle h : nb::iter(item.second)) approaches.push_back(nb::cast<std::optional<osrm::engine::Approach>>(h));
@@ -162,10 +159,17 @@ void init_MatchParameters(nb::module_& m) {
                                                 std::move(exclude),
                                                 snapping);
         })
-        .def_rw("timestamps", &MatchParameters::timestamps)
-        .def_rw("gaps", &MatchParameters::gaps)
-        .def_rw("tidy", &MatchParameters::tidy)
+        .def_prop_rw("timestamps",
+            [](const MatchParameters& p) { return p.timestamps; },
+            [](MatchParameters& p, nb::handle value) { p.timestamps = osrm_nb_util::to_timestamps(value); }, nb::lock_self())
+        .def_rw("gaps", &MatchParameters::gaps, nb::lock_self())
+        .def_rw("tidy", &MatchParameters::tidy, nb::lock_self())
+        .def("__eq__", &params_equal<MatchParameters>)
+        .def("cache_key", &params_cache_key<MatchParameters>,
+            "Returns the canonical key of the request as bytes, equal for two MatchParameters describing the same request.\n\n"
+            "Unlike the object itself, the key is immutable and hashable, and can be used as a dict key.")
         .def("IsValid", &MatchParameters::IsValid);
+    nb::type<MatchParameters>().attr("__hash__") = nb::none();
     // Expose enum directly (strings can be mapped manually in Python if needed)
     nb::enum_<MatchParameters::GapsType>(m, "MatchGapsType")
         .value("Split", MatchParameters::GapsType::Split)
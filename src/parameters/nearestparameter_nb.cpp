@@ -1,7 +1,11 @@
 #include "parameters/nearestparameter_nb.h"
+#include "parameters/baseparameter_nb.h"
 
 #include "engine/api/nearest_parameters.hpp"
+#include "utility/input_utility.h"
+#include "utility/param_key.h"
 #include "utility/param_utility.h"
+#include "utility/service_stats.h"
 #include "parameters/parse_helpers.h"
 
 #include <nanobind/nanobind.h>
@@ -35,6 +39,7 @@ void init_NearestParameters(nb::module_& m) {
                 BaseParameters (osrm.osrm_ext.BaseParameters): Attributes from parent class."
             )
     .def("__init__", [](NearestParameters* t, const nb::kwargs& kwargs){
+        osrm_nb_util::ScopedTimer build_timer(osrm_nb_util::build_histogram(osrm_nb_util::StatsService::Nearest));
         new (t) NearestParameters();
         std::vector<osrm::util::Coordinate> coordinates; std::vector<std::optional<osrm::engine::Hint>> hints; std::vector<std::optional<double>> radiuses; std::vector<std::optional<osrm::engine::Bearing>> bearings; std::vector<std::optional<osrm::engine::Approach>> approaches; bool generate_hints = true; std::vector<std::string> exclude; BaseParameters::SnappingType snapping = BaseParameters::SnappingType::Default; unsigned int number_of_results = t->number_of_results; // default 1 normally
 
@@ -42,14 +47,15 @@ void init_NearestParameters(nb::module_& m) {
 
         for(auto item: kwargs){
             std::string key = nb::cast<std::string>(item.first);
-            if(key=="coordinates") { for(nb::handle h: nb::iter(item.second)) { if(nb::isinstance<nb::tuple>(h)) { auto tup=nb::tuple(h); if(tup.size()!=2) throw std::runtime_error("Coordinate tuple must have length 2"); double lon=nb::cast<double>(tup[0]); double lat=nb::cast<double>(tup[1]); coordinates.emplace_back(osrm::util::FloatLongitude{lon}, osrm::util::FloatLatitude{lat}); } else coordinates.push_back(nb::cast<osrm::util::Coordinate>(h)); }}
+            if(key=="coordinates") coordinates = osrm_nb_util::to_coordinates(item.second);
             else if(key=="hints") { for(nb::handle h: nb::iter(item.second)) hints.push_back(nb::cast<std::optional<osrm::engine::Hint>>(h)); }
-            else if(key=="radiuses") { for(nb::handle h: nb::iter(item.second)) { if(h.is_none()) radiuses.push_back(std::optional<double>()); else radiuses.push_back(nb::cast<double>(h)); } }
-            else if(key=="bearings") { for(nb::handle h: nb::iter(item.second)) bearings.push_back(nb::cast<std::optional<osrm::engine::Bearing>>(h)); }
+            else if(key=="radiuses") radiuses = osrm_nb_util::to_radiuses(item.second);
+            else if(key=="bearings") bearings = osrm_nb_util::to_bearings(item.second);
             else if(key=="approaches") { for(nb::handle h: nb::iter(item.second)) approaches.push_back(nb::cast<std::optional<osrm::engine::Approach>>(h)); }
             else if(key=="generate_hints") generate_hints = nb::cast<bool>(item.second);
             else if(key=="exclude") { for(nb::handle h: nb::iter(item.second)) exclude.push_back(nb::cast<std::string>(h)); }
             else if(key=="snapping") { if(nb::isinstance<nb::str>(item.second)) snapping = parse_snapping(nb::cast<std::string>(item.second)); else snapping = nb::cast<BaseParameters::SnappingType>(item.second); }
+            else if(key=="format") { if(nb::isinstance<nb::str>(item.second)) t->format = parse_output_format(nb::cast<std::string>(item.second)); else t->format = nb::cast<BaseParameters::OutputFormatType>(item.second); }
             else if(key=="number_of_results") number_of_results = nb::cast<unsigned int>(item.second);
             else {
                 throw std::invalid_argument("Unknown NearestParameters argument: "+key);
@@ -59,6 +65,11 @@ void init_NearestParameters(nb::module_& m) {
         t->number_of_results = number_of_results;
         osrm_nb_util::assign_baseparameters(t, std::move(coordinates), std::move(hints), std::move(radiuses), std::move(bearings), approaches, generate_hints, std::move(exclude), snapping);
     })
-        .def_rw("number_of_results", &NearestParameters::number_of_results)
+        .def_rw("number_of_results", &NearestParameters::number_of_results, nb::lock_self())
+        .def("__eq__", &params_equal<NearestParameters>)
+        .def("cache_key", &params_cache_key<NearestParameters>,
+            "Returns the canonical key of the request as bytes, equal for two NearestParameters describing the same request.\n\n"
+            "Unlike the object itself, the key is immutable and hashable, and can be used as a dict key.")
         .def("IsValid", &NearestParameters::IsValid);
+    nb::type<NearestParameters>().attr("__hash__") = nb::none();
 }
@@ -1,7 +1,11 @@
 #include "parameters/routeparameter_nb.h"
+#include "parameters/baseparameter_nb.h"
 
 #include "engine/api/route_parameters.hpp"
+#include "utility/input_utility.h"
+#include "utility/param_key.h"
 #include "utility/param_utility.h"
+#include "utility/service_stats.h"
 #include "parameters/parse_helpers.h"
 
 #include <nanobind/nanobind.h>
@@ -48,7 +52,7 @@ void init_RouteParameters(nb::module_& m) {
                 geometries (string 'polyline' | 'polyline6' | 'geojson'): Returned route geometry format - influences overview and per step. (default "")\n\
                 overview (string 'simplified' | 'full' | 'false'): Add overview geometry either full, simplified. (default '')\n\
                 continue_straight (bool): Forces the route to keep going straight at waypoints, constraining u-turns. (default {})\n\
-                waypoints (list of int): Treats input coordinates indicated by given indices as waypoints in returned Match object. (default [])\n\
+                waypoints (list of int | numpy.ndarray): Treats input coordinates indicated by given indices as waypoints in returned Match object. (default [])\n\
                 BaseParameters (osrm.osrm_ext.BaseParameters): Keyword arguments from parent class.\n\n"
             "Returns:\n\
                 __init__ (osrm.RouteParameters): A RouteParameters object, for usage in Route.\n\
@@ -64,6 +68,7 @@ void init_RouteParameters(nb::module_& m) {
                 BaseParameters (osrm.osrm_ext.BaseParameters): Attributes from parent class."
             )
     .def("__init__", [](RouteParameters* t, const nb::kwargs& kwargs) {
+        osrm_nb_util::ScopedTimer build_timer(osrm_nb_util::build_histogram(osrm_nb_util::StatsService::Route));
         new (t) RouteParameters();
 
         // Defaults
@@ -108,20 +113,10 @@ void init_RouteParameters(nb::module_& m) {
                 if(item.second.is_none()) continue_straight.reset(); else continue_straight = nb::cast<bool>(item.second);
             }
             else if(key=="waypoints") {
-                for(nb::handle h : nb::iter(item.second)) waypoints.push_back(nb::cast<std::size_t>(h));
+                waypoints = osrm_nb_util::to_indices(item.second, "waypoints");
             }
             else if(key=="coordinates") {
-                for(nb::handle h : nb::iter(item.second)) {
-                    if(nb::isinstance<nb::tuple>(h)) {
-                        auto tup = nb::tuple(h);
-                        if(tup.size()!=2) throw std::runtime_error("Coordinate tuple must have length 2");
-                        double lon = nb::cast<double>(tup[0]);
-                        double lat = nb::cast<double>(tup[1]);
-                        coordinates.emplace_back(osrm::util::FloatLongitude{lon}, osrm::util::FloatLatitude{lat});
-                    } else {
-                        coordinates.push_back(nb::cast<osrm::util::Coordinate>(h));
-                    }
-                }
+                coordinates = osrm_nb_util::to_coordinates(item.second);
             }
             else if(key=="exclude") {
                 for(nb::handle h : nb::iter(item.second)) exclude.push_back(nb::cast<std::string>(h));
@@ -131,17 +126,19 @@ void init_RouteParameters(nb::module_& m) {
                 if(nb::isinstance<nb::str>(item.second)) snapping = parse_snapping(nb::cast<std::string>(item.second));
                 else snapping = nb::cast<BaseParameters::SnappingType>(item.second);
             }
-            // Other lists (hints, radiuses, bearings, approaches) kept simple: only accept already-typed values for now
+            else if(key=="format") {
+                if(nb::isinstance<nb::str>(item.second)) t->format = parse_output_format(nb::cast<std::string>(item.second));
+                else t->format = nb::cast<BaseParameters::OutputFormatType>(item.second);
+            }
+            // hints and approaches only accept already-typed values
             else if(key=="hints") {
                 for(nb::handle h : nb::iter(item.second)) hints.push_back(nb::cast<std::optional<osrm::engine::Hint>>(h));
             }
             else if(key=="radiuses") {
-                for(nb::handle h : nb::iter(item.second)) {
-                    if(h.is_none()) radiuses.push_back(std::optional<double>()); else radiuses.push_back(nb::cast<double>(h));
-                }
+                radiuses = osrm_nb_util::to_radiuses(item.second);
             }
             else if(key=="bearings") {
-                for(nb::handle h : nb::iter(item.second)) bearings.push_back(nb::cast<std::optional<osrm::engine::Bearing>>(h));
+                bearings = osrm_nb_util::to_bearings(item.second);
             }
             else if(key=="approaches") {
                 for(nb::handle h : nb::iter(item.second)) approaches.push_back(nb::cast<std::optional<osrm::engine::Approach>>(h));
@@ -170,14 +167,19 @@ void init_RouteParameters(nb::module_& m) {
                                             std::move(exclude),
                                             snapping);
     })
-        .def_rw("steps", &RouteParameters::steps)
-        .def_rw("alternatives", &RouteParameters::alternatives)
-        .def_rw("number_of_alternatives", &RouteParameters::number_of_alternatives)
-        .def_rw("annotations_type", &RouteParameters::annotations_type)
-        .def_rw("geometries", &RouteParameters::geometries)
-        .def_rw("overview", &RouteParameters::overview)
-        .def_rw("continue_straight", &RouteParameters::continue_straight)
+        .def_rw("steps", &RouteParameters::steps, nb::lock_self())
+        .def_rw("alternatives", &RouteParameters::alternatives, nb::lock_self())
+        .def_rw("number_of_alternatives", &RouteParameters::number_of_alternatives, nb::lock_self())
+        .def_rw("annotations_type", &RouteParameters::annotations_type, nb::lock_self())
+        .def_rw("geometries", &RouteParameters::geometries, nb::lock_self())
+        .def_rw("overview", &RouteParameters::overview, nb::lock_self())
+        .def_rw("continue_straight", &RouteParameters::continue_straight, nb::lock_self())
+        .def("__eq__", &params_equal<RouteParameters>)
+        .def("cache_key", &params_cache_key<RouteParameters>,
+            "Returns the canonical key of the request as bytes, equal for two RouteParameters describing the same request.\n\n"
+            "Unlike the object itself, the key is immutable and hashable, and can be used as a dict key.")
         .def("IsValid", &RouteParameters::IsValid);
+    nb::type<RouteParameters>().attr("__hash__") = nb::none();
 
     // Enums: expose directly; Python can still use strings via helper constructors if needed later.
     nb::enum_<RouteParameters::GeometriesType>(m, "RouteGeometriesType")
@@ -1,7 +1,11 @@
 #include "parameters/tableparameter_nb.h"
+#include "parameters/baseparameter_nb.h"
 
 #include "engine/api/table_parameters.hpp"
+#include "utility/input_utility.h"
+#include "utility/param_key.h"
 #include "utility/param_utility.h"
+#include "utility/service_stats.h"
 #include "parameters/parse_helpers.h"
 
 #include <nanobind/nanobind.h>
@@ -17,14 +21,6 @@ using namespace nb::literals;
 void init_TableParameters(nb::module_& m) {
     using osrm::engine::api::BaseParameters;
     using osrm::engine::api::TableParameters;
-static const std::unordered_map<std::string, TableParameters::AnnotationsType> table_annotations_map {
-    { "none", TableParameters::AnnotationsType::None },
-    { std::string(), TableParameters::AnnotationsType::None },
-    { "duration", TableParameters::AnnotationsType::Duration },
-    { "distance", TableParameters::AnnotationsType::Distance },
-    { "all", TableParameters::AnnotationsType::All }
-};
-
     nb::class_<TableParameters, BaseParameters>(m, "TableParameters")
         .def(nb::init<>(), "Instantiates an instance of TableParameters.\n\n"
             "Examples:\n\
@@ -40,8 +36,8 @@ static const std::unordered_map<std::string, TableParameters::AnnotationsType> t
                 >>> table_params.IsValid()\n\
                 True\n\n"
             "Args:\n\
-                sources (list of int): Use location with given index as source. (default [])\n\
-                destinations (list of int): Use location with given index as destination. (default [])\n\
+                sources (list of int | numpy.ndarray): Use location with given index as source. (default [])\n\
+                destinations (list of int | numpy.ndarray): Use location with given index as destination. (default [])\n\
                 annotations (list of 'none' | 'duration' | 'distance' | 'all'): \
                     Returns additional metadata for each coordinate along the route geometry. (default [])\n\
                 fallback_speed (float): If no route found between a source/destination pair, calculate the as-the-crow-flies distance, \
@@ -65,6 +61,7 @@ static const std::unordered_map<std::string, TableParameters::AnnotationsType> t
                 BaseParameters (osrm.osrm_ext.BaseParameters): Attributes from parent class."
             )
     .def("__init__", [](TableParameters* t, const nb::kwargs& kwargs){
+        osrm_nb_util::ScopedTimer build_timer(osrm_nb_util::build_histogram(osrm_nb_util::StatsService::Table));
         new (t) TableParameters();
 
         std::vector<std::size_t> sources;
@@ -86,8 +83,8 @@ static const std::unordered_map<std::string, TableParameters::AnnotationsType> t
 
         for(auto item: kwargs){
             std::string key = nb::cast<std::string>(item.first);
-            if(key=="sources") { for(nb::handle h: nb::iter(item.second)) sources.push_back(nb::cast<std::size_t>(h)); }
-            else if(key=="destinations") { for(nb::handle h: nb::iter(item.second)) destinations.push_back(nb::cast<std::size_t>(h)); }
+            if(key=="sources") sources = osrm_nb_util::to_indices(item.second, "sources");
+            else if(key=="destinations") destinations = osrm_nb_util::to_indices(item.second, "destinations");
         else if(key=="annotations") {
                 annotations_vec.clear();
                 for(nb::handle h: nb::iter(item.second)) {
@@ -102,13 +99,7 @@ static const std::unordered_map<std::string, TableParameters::AnnotationsType> t
             }
             else if(key=="scale_factor") scale_factor = nb::cast<double>(item.second);
             else if(key=="coordinates") {
-                for(nb::handle h: nb::iter(item.second)) {
-                    if(nb::isinstance<nb::tuple>(h)) {
-                        auto tup = nb::tuple(h); if(tup.size()!=2) throw std::runtime_error("Coordinate tuple must have length 2");
-                        double lon = nb::cast<double>(tup[0]); double lat = nb::cast<double>(tup[1]);
-                        coordinates.emplace_back(osrm::util::FloatLongitude{lon}, osrm::util::FloatLatitude{lat});
-                    } else coordinates.push_back(nb::cast<osrm::util::Coordinate>(h));
-                }
+                coordinates = osrm_nb_util::to_coordinates(item.second);
             }
             else if(key=="exclude") { for(nb::handle h: nb::iter(item.second)) exclude.push_back(nb::cast<std::string>(h)); }
             else if(key=="generate_hints") generate_hints = nb::cast<bool>(item.second);
@@ -116,9 +107,13 @@ static const std::unordered_map<std::string, TableParameters::AnnotationsType> t
                 if(nb::isinstance<nb::str>(item.second)) snapping = parse_snapping(nb::cast<std::string>(item.second));
                 else snapping = nb::cast<BaseParameters::SnappingType>(item.second);
             }
+            else if(key=="format") {
+                if(nb::isinstance<nb::str>(item.second)) t->format = parse_output_format(nb::cast<std::string>(item.second));
+                else t->format = nb::cast<BaseParameters::OutputFormatType>(item.second);
+            }
             else if(key=="hints") { for(nb::handle h: nb::iter(item.second)) hints.push_back(nb::cast<std::optional<osrm::engine::Hint>>(h)); }
-            else if(key=="radiuses") { for(nb::handle h: nb::iter(item.second)) { if(h.is_none()) radiuses.push_back(std::optional<double>()); else radiuses.push_back(nb::cast<double>(h)); } }
-            else if(key=="bearings") { for(nb::handle h: nb::iter(item.second)) bearings.push_back(nb::cast<std::optional<osrm::engine::Bearing>>(h)); }
+            else if(key=="radiuses") radiuses = osrm_nb_util::to_radiuses(item.second);
+            else if(key=="bearings") bearings = osrm_nb_util::to_bearings(item.second);
             else if(key=="approaches") { for(nb::handle h: nb::iter(item.second)) approaches.push_back(nb::cast<std::optional<osrm::engine::Approach>>(h)); }
             else {
                 throw std::invalid_argument("Unknown TableParameters argument: "+key);
@@ -142,13 +137,22 @@ static const std::unordered_map<std::string, TableParameters::AnnotationsType> t
                                             std::move(exclude),
                                             snapping);
     })
-        .def_rw("sources", &TableParameters::sources)
-        .def_rw("destinations", &TableParameters::destinations)
-        .def_rw("fallback_speed", &TableParameters::fallback_speed)
-        .def_rw("fallback_coordinate_type", &TableParameters::fallback_coordinate_type)
-        .def_rw("annotations", &TableParameters::annotations)
-        .def_rw("scale_factor", &TableParameters::scale_factor)
+        .def_prop_rw("sources",
+            [](const TableParameters& p) { return p.sources; },
+            [](TableParameters& p, nb::handle value) { p.sources = osrm_nb_util::to_indices(value, "sources"); }, nb::lock_self())
+        .def_prop_rw("destinations",
+            [](const TableParameters& p) { return p.destinations; },
+            [](TableParameters& p, nb::handle value) { p.destinations = osrm_nb_util::to_indices(value, "destinations"); }, nb::lock_self())
+        .def_rw("fallback_speed", &TableParameters::fallback_speed, nb::lock_self())
+        .def_rw("fallback_coordinate_type", &TableParameters::fallback_coordinate_type, nb::lock_self())
+        .def_rw("annotations", &TableParameters::annotations, nb::lock_self())
+        .def_rw("scale_factor", &TableParameters::scale_factor, nb::lock_self())
+        .def("__eq__", &params_equal<TableParameters>)
+        .def("cache_key", &params_cache_key<TableParameters>,
+            "Returns the canonical key of the request as bytes, equal for two TableParameters describing the same request.\n\n"
+            "Unlike the object itself, the key is immutable and hashable, and can be used as a dict key.")
         .def("IsValid", &TableParameters::IsValid);
+    nb::type<TableParameters>().attr("__hash__") = nb::none();
 
     nb::enum_<TableParameters::FallbackCoordinateType>(m, "TableFallbackCoordinateType")
         .value("Input", TableParameters::FallbackCoordinateType::Input)
@@ -1,6 +1,7 @@
 #include "parameters/tileparameter_nb.h"
 
 #include "engine/api/tile_parameters.hpp"
+#include "utility/service_stats.h"
 
 #include <nanobind/nanobind.h>
 #include <nanobind/stl/string.h>
@@ -39,6 +40,7 @@ void init_TileParameters(nb::module_& m) {
                 z (int): z value."
             )
         .def("__init__", [](TileParameters* t, nb::args args, const nb::kwargs& kwargs){
+            osrm_nb_util::ScopedTimer build_timer(osrm_nb_util::build_histogram(osrm_nb_util::StatsService::Tile));
             unsigned int x = 0, y = 0, z = 0; bool set_any=false;
             // Positional compatibility:
             if(args.size()==1) {
@@ -71,9 +73,9 @@ void init_TileParameters(nb::module_& m) {
             if(!set_any) throw std::runtime_error("TileParameters requires x,y,z or tile=[x,y,z]");
             new (t) TileParameters{x,y,z};
         })
-        .def_rw("x", &TileParameters::x)
-        .def_rw("y", &TileParameters::y)
-        .def_rw("z", &TileParameters::z)
+        .def_rw("x", &TileParameters::x, nb::lock_self())
+        .def_rw("y", &TileParameters::y, nb::lock_self())
+        .def_rw("z", &TileParameters::z, nb::lock_self())
         .def("IsValid", &TileParameters::IsValid);
     // Removed implicit conversion; kwargs/tile list used instead.
 }
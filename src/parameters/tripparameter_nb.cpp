@@ -1,7 +1,11 @@
 #include "parameters/tripparameter_nb.h"
+#include "parameters/baseparameter_nb.h"
 
 #include "engine/api/trip_parameters.hpp"
+#include "utility/input_utility.h"
+#include "utility/param_key.h"
 #include "utility/param_utility.h"
+#include "utility/service_stats.h"
 #include "parameters/parse_helpers.h"
 
 #include <nanobind/nanobind.h>
@@ -42,6 +46,7 @@ void init_TripParameters(nb::module_& m) {
                 RouteParameters (osrm.RouteParameters): Attributes from parent class."
             )
     .def("__init__", [](TripParameters* t, const nb::kwargs& kwargs){
+        osrm_nb_util::ScopedTimer build_timer(osrm_nb_util::build_histogram(osrm_nb_util::StatsService::Trip));
         new (t) TripParameters();
 
         // RouteParameters defaults
@@ -72,14 +77,15 @@ void init_TripParameters(nb::module_& m) {
             else if(key=="geometries") { if(nb::isinstance<nb::str>(item.second)) geometries = parse_geometries(nb::cast<std::string>(item.second)); else geometries = nb::cast<RouteParameters::GeometriesType>(item.second); }
             else if(key=="overview") { if(nb::isinstance<nb::str>(item.second)) overview = parse_overview(nb::cast<std::string>(item.second)); else overview = nb::cast<RouteParameters::OverviewType>(item.second); }
             else if(key=="continue_straight") { if(item.second.is_none()) continue_straight.reset(); else continue_straight = nb::cast<bool>(item.second); }
-            else if(key=="waypoints") { for(nb::handle h: nb::iter(item.second)) waypoints.push_back(nb::cast<std::size_t>(h)); }
-            else if(key=="coordinates") { for(nb::handle h: nb::iter(item.second)) { if(nb::isinstance<nb::tuple>(h)) { auto tup=nb::tuple(h); if(tup.size()!=2) throw std::runtime_error("Coordinate tuple must have length 2"); double lon=nb::cast<double>(tup[0]); double lat=nb::cast<double>(tup[1]); coordinates.emplace_back(osrm::util::FloatLongitude{lon}, osrm::util::FloatLatitude{lat}); } else coordinates.push_back(nb::cast<osrm::util::Coordinate>(h)); }}
+            else if(key=="waypoints") waypoints = osrm_nb_util::to_indices(item.second, "waypoints");
+            else if(key=="coordinates") coordinates = osrm_nb_util::to_coordinates(item.second);
             else if(key=="exclude") { for(nb::handle h: nb::iter(item.second)) exclude.push_back(nb::cast<std::string>(h)); }
             else if(key=="generate_hints") generate_hints = nb::cast<bool>(item.second);
             else if(key=="snapping") { if(nb::isinstance<nb::str>(item.second)) snapping = parse_snapping(nb::cast<std::string>(item.second)); else snapping = nb::cast<BaseParameters::SnappingType>(item.second); }
+            else if(key=="format") { if(nb::isinstance<nb::str>(item.second)) t->format = parse_output_format(nb::cast<std::string>(item.second)); else t->format = nb::cast<BaseParameters::OutputFormatType>(item.second); }
             else if(key=="hints") { for(nb::handle h: nb::iter(item.second)) hints.push_back(nb::cast<std::optional<osrm::engine::Hint>>(h)); }
-            else if(key=="radiuses") { for(nb::handle h: nb::iter(item.second)) { if(h.is_none()) radiuses.push_back(std::optional<double>()); else radiuses.push_back(nb::cast<double>(h)); }}
-            else if(key=="bearings") { for(nb::handle h: nb::iter(item.second)) bearings.push_back(nb::cast<std::optional<osrm::engine::Bearing>>(h)); }
+            else if(key=="radiuses") radiuses = osrm_nb_util::to_radiuses(item.second);
+            else if(key=="bearings") bearings = osrm_nb_util::to_bearings(item.second);
             else if(key=="approaches") { for(nb::handle h: nb::iter(item.second)) approaches.push_back(nb::cast<std::optional<osrm::engine::Approach>>(h)); }
             else if(key=="alternatives") { number_of_alternatives = nb::cast<int>(item.second); }
             else {
@@ -91,10 +97,15 @@ void init_TripParameters(nb::module_& m) {
         osrm_nb_util::assign_routeparameters(t, steps, number_of_alternatives, ann_enums, geometries, overview, continue_straight, waypoints);
         osrm_nb_util::assign_baseparameters(t, std::move(coordinates), std::move(hints), std::move(radiuses), std::move(bearings), approaches, generate_hints, std::move(exclude), snapping);
     })
-        .def_rw("source", &TripParameters::source)
-        .def_rw("destination", &TripParameters::destination)
-        .def_rw("roundtrip", &TripParameters::roundtrip)
+        .def_rw("source", &TripParameters::source, nb::lock_self())
+        .def_rw("destination", &TripParameters::destination, nb::lock_self())
+        .def_rw("roundtrip", &TripParameters::roundtrip, nb::lock_self())
+        .def("__eq__", &params_equal<TripParameters>)
+        .def("cache_key", &params_cache_key<TripParameters>,
+            "Returns the canonical key of the request as bytes, equal for two TripParameters describing the same request.\n\n"
+            "Unlike the object itself, the key is immutable and hashable, and can be used as a dict key.")
         .def("IsValid", &TripParameters::IsValid);
+    nb::type<TripParameters>().attr("__hash__") = nb::none();
 
     nb::enum_<TripParameters::SourceType>(m, "TripSourceType")
         .value("Any", TripParameters::SourceType::Any)
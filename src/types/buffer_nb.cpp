@@ -0,0 +1,64 @@
+#include "types/buffer_nb.h"
+
+#include <flatbuffers/flatbuffers.h>
+
+#include <nanobind/nanobind.h>
+
+#include <memory>
+#include <string>
+
+namespace nb = nanobind;
+
+namespace {
+
+int buffer_getbuffer(PyObject* exporter, Py_buffer* view, int flags) {
+    const Buffer* buffer = nb::inst_ptr<Buffer>(exporter);
+    return PyBuffer_FillInfo(view, exporter, const_cast<char*>(buffer->data),
+                             static_cast<Py_ssize_t>(buffer->size), 1, flags);
+}
+
+PyType_Slot buffer_slots[] = {
+    { Py_bf_getbuffer, (void*) buffer_getbuffer },
+    { 0, nullptr }
+};
+
+} //namespace
+
+Buffer Buffer::from_string(std::string&& str) {
+    auto owned = std::make_shared<const std::string>(std::move(str));
+
+    Buffer buffer;
+    buffer.data = owned->data();
+    buffer.size = owned->size();
+    buffer.owner = std::move(owned);
+    return buffer;
+}
+
+Buffer Buffer::from_flatbuffer(flatbuffers::FlatBufferBuilder&& builder) {
+    return from_flatbuffer(std::make_shared<const flatbuffers::DetachedBuffer>(builder.Release()));
+}
+
+Buffer Buffer::from_flatbuffer(std::shared_ptr<const flatbuffers::DetachedBuffer> owned) {
+    Buffer buffer;
+    buffer.data = reinterpret_cast<const char*>(owned->data());
+    buffer.size = owned->size();
+    buffer.owner = std::move(owned);
+    return buffer;
+}
+
+void init_Buffer(nb::module_& m) {
+    nb::class_<Buffer>(m, "Buffer", nb::type_slots(buffer_slots),
+            "Read-only response bytes, exposed through the buffer protocol without a copy.\n\n"
+            "Examples:\n\
+                >>> view = memoryview(res)\n\
+                >>> data = bytes(res)\n\n"
+            "Returns:\n\
+                __len__ (int): Size of the buffer in bytes."
+            )
+        .def("__len__", [](const Buffer& buffer) {
+            return buffer.size;
+        })
+        .def("__bool__", [](const Buffer& buffer) {
+            return buffer.size != 0;
+        });
+}
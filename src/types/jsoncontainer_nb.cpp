@@ -3,14 +3,63 @@
 #include "util/json_container.hpp"
 
 #include <nanobind/nanobind.h>
-#include <nanobind/make_iterator.h>
 #include <nanobind/stl/string.h>
+#include <utility>
 #include <variant>
 
 namespace nb = nanobind;
 namespace json = osrm::util::json;
 
+namespace {
+
+// Iterators walk the tree in place and keep their container alive through owner
+struct ObjectIterator {
+    enum class Kind { Keys, Values, Items };
+    using Iter = decltype(std::declval<const json::Object&>().values.begin());
+
+    nb::object owner;
+    Iter itr;
+    Iter end;
+    Kind kind;
+};
+
+struct ArrayIterator {
+    nb::object owner;
+    const json::Array* arr;
+    std::size_t index;
+};
+
+ObjectIterator make_object_iterator(nb::pointer_and_handle<json::Object> self, ObjectIterator::Kind kind) {
+    return ObjectIterator{ nb::borrow(self.h), self.p->values.begin(), self.p->values.end(), kind };
+}
+
+} //namespace
+
 void init_JSONContainer(nb::module_& m) {
+    nb::class_<ObjectIterator>(m, "ObjectIterator")
+        .def("__iter__", [](nb::handle self) {
+            return nb::borrow(self);
+        })
+        .def("__next__", [](ObjectIterator& it) -> nb::object {
+            if (it.itr == it.end) throw nb::stop_iteration();
+            auto const &kv = *it.itr++;
+            nb::str key(kv.first.data(), kv.first.size());
+            switch (it.kind) {
+                case ObjectIterator::Kind::Keys: return key;
+                case ObjectIterator::Kind::Values: return json_value_to_lazy_py(kv.second, it.owner);
+                default: return nb::make_tuple(key, json_value_to_lazy_py(kv.second, it.owner));
+            }
+        });
+
+    nb::class_<ArrayIterator>(m, "ArrayIterator")
+        .def("__iter__", [](nb::handle self) {
+            return nb::borrow(self);
+        })
+        .def("__next__", [](ArrayIterator& it) -> nb::object {
+            if (it.index >= it.arr->values.size()) throw nb::stop_iteration();
+            return json_value_to_lazy_py(it.arr->values[it.index++], it.owner);
+        });
+
     nb::class_<json::Object>(m, "Object")
         .def(nb::init<>())
         .def("__len__", [](const json::Object& obj) {
@@ -23,27 +72,29 @@ void init_JSONContainer(nb::module_& m) {
             ValueStringifyVisitor visitor;
             return visitor.visitobject(obj);
         })
-        .def("__getitem__", [](const json::Object& obj, const std::string& key) -> nb::object {
-            auto it = obj.values.find(key);
-            if (it == obj.values.end()) throw nb::key_error((std::string("Key not found: ") + key).c_str());
-            return std::visit(ToPythonVisitor{}, it->second);
+        .def("__contains__", [](const json::Object& obj, const std::string& key) {
+            return obj.values.find(key) != obj.values.end();
+        })
+        .def("__getitem__", [](nb::pointer_and_handle<json::Object> self, const std::string& key) -> nb::object {
+            auto it = self.p->values.find(key);
+            if (it == self.p->values.end()) throw nb::key_error((std::string("Key not found: ") + key).c_str());
+            return json_value_to_lazy_py(it->second, self.h);
         })
-        .def("get", [](const json::Object& obj, const std::string& key, nb::object default_) -> nb::object {
-            auto it = obj.values.find(key);
-            if (it == obj.values.end()) return default_;
-            return std::visit(ToPythonVisitor{}, it->second);
+        .def("get", [](nb::pointer_and_handle<json::Object> self, const std::string& key, nb::object default_) -> nb::object {
+            auto it = self.p->values.find(key);
+            if (it == self.p->values.end()) return default_;
+            return json_value_to_lazy_py(it->second, self.h);
         }, nb::arg("key"), nb::arg("default") = nb::none())
-        .def("keys", [](const json::Object& obj) {
-            nb::list keys; for (auto const &kv : obj.values) keys.append(nb::str(kv.first.data(), kv.first.size())); return keys; })
-        .def("values", [](const json::Object& obj) {
-            nb::list vals; for (auto const &kv : obj.values) vals.append(json_value_to_py(kv.second)); return vals; })
-        .def("items", [](const json::Object& obj) {
-            nb::list items; for (auto const &kv : obj.values) { nb::tuple t = nb::make_tuple(nb::str(kv.first.data(), kv.first.size()), json_value_to_py(kv.second)); items.append(t);} return items; })
-        .def("__iter__", [](const json::Object& obj) {
-            nb::list keys;
-            for (auto const &kv : obj.values) keys.append(nb::str(kv.first.data(), kv.first.size()));
-            return keys; // list is iterable
-        });
+        .def("keys", [](nb::pointer_and_handle<json::Object> self) {
+            return make_object_iterator(self, ObjectIterator::Kind::Keys); })
+        .def("values", [](nb::pointer_and_handle<json::Object> self) {
+            return make_object_iterator(self, ObjectIterator::Kind::Values); })
+        .def("items", [](nb::pointer_and_handle<json::Object> self) {
+            return make_object_iterator(self, ObjectIterator::Kind::Items); })
+        .def("__iter__", [](nb::pointer_and_handle<json::Object> self) {
+            return make_object_iterator(self, ObjectIterator::Kind::Keys); })
+        .def("to_dict", [](const json::Object& obj) {
+            return json_object_to_py(obj); });
 
     nb::class_<json::Array>(m, "Array")
         .def(nb::init<>())
@@ -57,12 +108,14 @@ void init_JSONContainer(nb::module_& m) {
             ValueStringifyVisitor visitor;
             return visitor.visitarray(arr);
         })
-        .def("__getitem__", [](const json::Array& arr, int i) -> nb::object {
-            if (i < 0 || static_cast<size_t>(i) >= arr.values.size()) throw nb::index_error();
-            return json_value_to_py(arr.values[i]);
+        .def("__getitem__", [](nb::pointer_and_handle<json::Array> self, int i) -> nb::object {
+            const auto size = static_cast<int>(self.p->values.size());
+            if (i < 0) i += size;
+            if (i < 0 || i >= size) throw nb::index_error();
+            return json_value_to_lazy_py(self.p->values[i], self.h);
         })
-        .def("__iter__", [](const json::Array& arr) {
-            nb::list out; for (auto const &v : arr.values) out.append(json_value_to_py(v)); return out; })
+        .def("__iter__", [](nb::pointer_and_handle<json::Array> self) {
+            return ArrayIterator{ nb::borrow(self.h), self.p, 0 }; })
         .def("to_list", [](const json::Array& arr) {
             nb::list out; for (auto const &v : arr.values) out.append(json_value_to_py(v)); return out; })
         .def("append", [](json::Array& arr, nb::object) {
@@ -0,0 +1,446 @@
+#include "utility/array_utility.h"
+
+#include "util/json_container.hpp"
+
+#include <nanobind/nanobind.h>
+#include <nanobind/ndarray.h>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <variant>
+
+namespace nb = nanobind;
+namespace json = osrm::util::json;
+using osrm::engine::api::TableParameters;
+
+namespace {
+
+constexpr std::size_t default_block_size = 512;
+
+const json::Array* find_array(const json::Object& obj, const char* key) {
+    auto itr = obj.values.find(key);
+    if(itr == obj.values.end() || !std::holds_alternative<json::Array>(itr->second)) {
+        return nullptr;
+    }
+    return &std::get<json::Array>(itr->second);
+}
+
+double number_or_nan(const json::Value& value) {
+    if(std::holds_alternative<json::Number>(value)) {
+        return std::get<json::Number>(value).value;
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+double number_field(const json::Object& obj, const char* key) {
+    auto itr = obj.values.find(key);
+    return itr == obj.values.end() ? std::numeric_limits<double>::quiet_NaN() : number_or_nan(itr->second);
+}
+
+// Annotations that become float64 columns, in the order they are returned
+constexpr const char* float_annotations[] = { "duration", "distance", "speed", "weight", "datasources" };
+
+void fill_geometry(const json::Object& route, std::vector<double>& out) {
+    auto itr = route.values.find("geometry");
+    if(itr == route.values.end() || !std::holds_alternative<json::Object>(itr->second)) {
+        return;
+    }
+    const json::Array* line = find_array(std::get<json::Object>(itr->second), "coordinates");
+    if(line == nullptr) {
+        return;
+    }
+
+    out.reserve(line->values.size() * 2);
+    for(const auto& value : line->values) {
+        const auto& point = std::get<json::Array>(value).values;
+        out.push_back(number_or_nan(point[0]));
+        out.push_back(number_or_nan(point[1]));
+    }
+}
+
+void fill_matrix(const json::Array& table, std::size_t cols, std::vector<double>& out) {
+    out.resize(table.values.size() * cols, std::numeric_limits<double>::quiet_NaN());
+
+    for(std::size_t r = 0; r < table.values.size(); ++r) {
+        const auto& row = std::get<json::Array>(table.values[r]).values;
+        for(std::size_t c = 0; c < row.size() && c < cols; ++c) {
+            out[r * cols + c] = number_or_nan(row[c]);
+        }
+    }
+}
+
+nb::object waypoints_to_py(const json::Array* waypoints) {
+    if(waypoints == nullptr) {
+        return nb::none();
+    }
+
+    const std::size_t n = waypoints->values.size();
+    std::vector<double> location(n * 2, std::numeric_limits<double>::quiet_NaN());
+    std::vector<double> distance(n, std::numeric_limits<double>::quiet_NaN());
+    // Tracepoints of a Match response, null for the points that were not matched
+    std::vector<std::int64_t> matchings_index;
+    std::vector<std::int64_t> waypoint_index;
+    nb::list names;
+    nb::list hints;
+
+    for(std::size_t i = 0; i < n; ++i) {
+        const auto* object = std::get_if<json::Object>(&waypoints->values[i]);
+        if(object == nullptr) {
+            names.append(nb::none());
+            hints.append(nb::none());
+            continue;
+        }
+        const auto& wp = *object;
+
+        if(auto matching = wp.values.find("matchings_index"); matching != wp.values.end()) {
+            matchings_index.resize(n, -1);
+            waypoint_index.resize(n, -1);
+            matchings_index[i] = static_cast<std::int64_t>(number_or_nan(matching->second));
+            if(auto index = wp.values.find("waypoint_index"); index != wp.values.end()) {
+                waypoint_index[i] = static_cast<std::int64_t>(number_or_nan(index->second));
+            }
+        }
+
+        if(const json::Array* loc = find_array(wp, "location"); loc && loc->values.size() == 2) {
+            location[i * 2] = number_or_nan(loc->values[0]);
+            location[i * 2 + 1] = number_or_nan(loc->values[1]);
+        }
+
+        auto dist = wp.values.find("distance");
+        if(dist != wp.values.end()) {
+            distance[i] = number_or_nan(dist->second);
+        }
+
+        auto name = wp.values.find("name");
+        if(name != wp.values.end() && std::holds_alternative<json::String>(name->second)) {
+            const std::string& str = std::get<json::String>(name->second).value;
+            names.append(nb::str(str.c_str(), str.size()));
+        } else {
+            names.append(nb::none());
+        }
+
+        auto hint = wp.values.find("hint");
+        if(hint != wp.values.end() && std::holds_alternative<json::String>(hint->second)) {
+            const std::string& str = std::get<json::String>(hint->second).value;
+            hints.append(nb::str(str.c_str(), str.size()));
+        } else {
+            hints.append(nb::none());
+        }
+    }
+
+    nb::dict columns;
+    columns["location"] = osrm_nb_util::to_ndarray(std::move(location), {n, 2});
+    columns["distance"] = osrm_nb_util::to_ndarray(std::move(distance), {n});
+    columns["name"] = names;
+    columns["hint"] = hints;
+    if(!matchings_index.empty()) {
+        columns["matchings_index"] = osrm_nb_util::to_ndarray(std::move(matchings_index), {n});
+        columns["waypoint_index"] = osrm_nb_util::to_ndarray(std::move(waypoint_index), {n});
+    }
+
+    return columns;
+}
+
+} //namespace
+
+namespace osrm_nb_util {
+
+nb::ndarray<nb::numpy, bool> to_bool_ndarray(std::vector<std::uint8_t>&& data, std::initializer_list<std::size_t> shape) {
+    auto* owned = new std::vector<std::uint8_t>(std::move(data));
+    nb::capsule owner(owned, [](void* p) noexcept {
+        delete static_cast<std::vector<std::uint8_t>*>(p);
+    });
+
+    return nb::ndarray<nb::numpy, bool>(reinterpret_cast<bool*>(owned->data()), shape, owner);
+}
+
+TableArrays table_to_arrays(const json::Object& result) {
+    TableArrays arrays;
+
+    const json::Array* durations = find_array(result, "durations");
+    const json::Array* distances = find_array(result, "distances");
+    const json::Array* any = durations ? durations : distances;
+
+    if(any != nullptr) {
+        arrays.rows = any->values.size();
+        if(arrays.rows > 0) {
+            arrays.cols = std::get<json::Array>(any->values.front()).values.size();
+        }
+    }
+
+    if(durations != nullptr) {
+        arrays.has_durations = true;
+        fill_matrix(*durations, arrays.cols, arrays.durations);
+    }
+    if(distances != nullptr) {
+        arrays.has_distances = true;
+        fill_matrix(*distances, arrays.cols, arrays.distances);
+    }
+
+    arrays.fallback_speed_cells.assign(arrays.rows * arrays.cols, 0);
+    if(const json::Array* cells = find_array(result, "fallback_speed_cells")) {
+        for(const auto& cell : cells->values) {
+            const auto& rc = std::get<json::Array>(cell).values;
+            const auto r = static_cast<std::size_t>(std::get<json::Number>(rc[0]).value);
+            const auto c = static_cast<std::size_t>(std::get<json::Number>(rc[1]).value);
+            if(r < arrays.rows && c < arrays.cols) {
+                arrays.fallback_speed_cells[r * arrays.cols + c] = 1;
+            }
+        }
+    }
+
+    return arrays;
+}
+
+void copy_table_block(const json::Object& result, TableArrays& arrays, std::size_t row, std::size_t col) {
+    auto copy_matrix = [&](const json::Array* table, std::vector<double>& out) {
+        if(table == nullptr) {
+            return;
+        }
+        for(std::size_t r = 0; r < table->values.size() && row + r < arrays.rows; ++r) {
+            const auto& cells = std::get<json::Array>(table->values[r]).values;
+            double* dst = out.data() + (row + r) * arrays.cols + col;
+            for(std::size_t c = 0; c < cells.size() && col + c < arrays.cols; ++c) {
+                dst[c] = number_or_nan(cells[c]);
+            }
+        }
+    };
+
+    if(arrays.has_durations) {
+        copy_matrix(find_array(result, "durations"), arrays.durations);
+    }
+    if(arrays.has_distances) {
+        copy_matrix(find_array(result, "distances"), arrays.distances);
+    }
+
+    if(const json::Array* cells = find_array(result, "fallback_speed_cells")) {
+        for(const auto& cell : cells->values) {
+            const auto& rc = std::get<json::Array>(cell).values;
+            const auto r = row + static_cast<std::size_t>(std::get<json::Number>(rc[0]).value);
+            const auto c = col + static_cast<std::size_t>(std::get<json::Number>(rc[1]).value);
+            if(r < arrays.rows && c < arrays.cols) {
+                arrays.fallback_speed_cells[r * arrays.cols + c] = 1;
+            }
+        }
+    }
+}
+
+std::size_t table_block_size(std::size_t block_size, int max_locations) {
+    if(block_size == 0) {
+        block_size = default_block_size;
+    }
+    if(max_locations > 0) {
+        // The engine rejects a Table with more than max_locations^2 sources x destinations
+        block_size = std::min(block_size, static_cast<std::size_t>(max_locations));
+    }
+    return std::max<std::size_t>(block_size, 1);
+}
+
+bool has_annotation(TableParameters::AnnotationsType annotations, TableParameters::AnnotationsType flag) {
+    return (static_cast<int>(annotations) & static_cast<int>(flag)) != 0;
+}
+
+void append_coordinate(TableParameters& table,
+                       const TableParameters& params,
+                       const std::vector<std::optional<osrm::engine::Hint>>& hints,
+                       std::size_t i)
+{
+    table.coordinates.push_back(params.coordinates[i]);
+    if(!hints.empty()) table.hints.push_back(hints[i]);
+    if(!params.radiuses.empty()) table.radiuses.push_back(params.radiuses[i]);
+    if(!params.bearings.empty()) table.bearings.push_back(params.bearings[i]);
+    if(!params.approaches.empty()) table.approaches.push_back(params.approaches[i]);
+}
+
+nb::dict table_arrays_to_py(TableArrays&& arrays, const json::Object& result) {
+    const std::size_t rows = arrays.rows;
+    const std::size_t cols = arrays.cols;
+
+    nb::dict out;
+    out["code"] = "Ok";
+    out["durations"] = arrays.has_durations ? nb::cast(to_ndarray(std::move(arrays.durations), {rows, cols})) : nb::none();
+    out["distances"] = arrays.has_distances ? nb::cast(to_ndarray(std::move(arrays.distances), {rows, cols})) : nb::none();
+    out["fallback_speed_cells"] = to_bool_ndarray(std::move(arrays.fallback_speed_cells), {rows, cols});
+    out["sources"] = waypoints_to_py(find_array(result, "sources"));
+    out["destinations"] = waypoints_to_py(find_array(result, "destinations"));
+
+    return out;
+}
+
+std::vector<RouteArrays> route_to_arrays(const json::Object& result, bool keep_distance) {
+    std::vector<RouteArrays> routes;
+
+    const json::Array* list = find_array(result, "routes");
+    if(list == nullptr) {
+        list = find_array(result, "matchings");
+    }
+    if(list == nullptr) {
+        return routes;
+    }
+
+    routes.reserve(list->values.size());
+    for(const auto& value : list->values) {
+        const auto& route = std::get<json::Object>(value);
+        RouteArrays& arrays = routes.emplace_back();
+
+        arrays.duration = number_field(route, "duration");
+        arrays.distance = number_field(route, "distance");
+        arrays.weight = number_field(route, "weight");
+        arrays.confidence = number_field(route, "confidence");
+        fill_geometry(route, arrays.geometry);
+
+        // Column index into arrays.annotations per float_annotations entry, created on first sight
+        constexpr std::size_t num_floats = std::size(float_annotations);
+        std::size_t column[num_floats];
+        std::fill(std::begin(column), std::end(column), num_floats);
+
+        arrays.leg_offsets.push_back(0);
+        arrays.node_offsets.push_back(0);
+        const json::Array* legs = find_array(route, "legs");
+        for(std::size_t l = 0; legs != nullptr && l < legs->values.size(); ++l) {
+            const auto& leg = std::get<json::Object>(legs->values[l]);
+            std::size_t segments = 0;
+            std::size_t nodes = 0;
+
+            auto annotation = leg.values.find("annotation");
+            if(annotation != leg.values.end() && std::holds_alternative<json::Object>(annotation->second)) {
+                const auto& columns = std::get<json::Object>(annotation->second);
+
+                for(std::size_t a = 0; a < num_floats; ++a) {
+                    const json::Array* values = find_array(columns, float_annotations[a]);
+                    if(values == nullptr) {
+                        continue;
+                    }
+                    segments = values->values.size();
+                    if(!keep_distance && std::string_view(float_annotations[a]) == "distance") {
+                        continue;
+                    }
+                    if(column[a] == num_floats) {
+                        column[a] = arrays.annotations.size();
+                        arrays.annotations.emplace_back(float_annotations[a], std::vector<double>{});
+                    }
+                    auto& out = arrays.annotations[column[a]].second;
+                    for(const auto& v : values->values) {
+                        out.push_back(number_or_nan(v));
+                    }
+                }
+
+                if(const json::Array* values = find_array(columns, "nodes")) {
+                    arrays.has_nodes = true;
+                    nodes = values->values.size();
+                    for(const auto& v : values->values) {
+                        arrays.nodes.push_back(static_cast<std::uint64_t>(std::get<json::Number>(v).value));
+                    }
+                }
+            }
+
+            arrays.leg_offsets.push_back(arrays.leg_offsets.back() + static_cast<std::int64_t>(segments));
+            arrays.node_offsets.push_back(arrays.node_offsets.back() + static_cast<std::int64_t>(nodes));
+        }
+    }
+
+    return routes;
+}
+
+nb::dict route_arrays_to_py(std::vector<RouteArrays>&& routes, const json::Object& result) {
+    const bool is_match = result.values.count("matchings") > 0;
+
+    nb::list list;
+    for(auto& arrays : routes) {
+        const std::size_t points = arrays.geometry.size() / 2;
+        const std::size_t offsets = arrays.leg_offsets.size();
+
+        nb::dict annotations;
+        for(auto& [name, values] : arrays.annotations) {
+            const std::size_t n = values.size();
+            annotations[name.c_str()] = to_ndarray(std::move(values), {n});
+        }
+        if(arrays.has_nodes) {
+            const std::size_t n = arrays.nodes.size();
+            annotations["nodes"] = to_ndarray(std::move(arrays.nodes), {n});
+            annotations["node_offsets"] = to_ndarray(std::move(arrays.node_offsets), {offsets});
+        }
+
+        nb::dict route;
+        route["duration"] = arrays.duration;
+        route["distance"] = arrays.distance;
+        route["weight"] = arrays.weight;
+        if(is_match) {
+            route["confidence"] = arrays.confidence;
+        }
+        route["geometry"] = to_ndarray(std::move(arrays.geometry), {points, 2});
+        route["leg_offsets"] = to_ndarray(std::move(arrays.leg_offsets), {offsets});
+        route["annotations"] = annotations;
+        list.append(route);
+    }
+
+    nb::dict out;
+    out["code"] = "Ok";
+    if(is_match) {
+        out["matchings"] = list;
+        out["tracepoints"] = waypoints_to_py(find_array(result, "tracepoints"));
+    } else {
+        out["routes"] = list;
+        out["waypoints"] = waypoints_to_py(find_array(result, "waypoints"));
+    }
+
+    return out;
+}
+
+nb::dict trip_arrays_to_py(TripArrays&& arrays) {
+    const std::size_t n = arrays.size;
+    const std::size_t m = arrays.permutation.size();
+
+    nb::dict out;
+    out["offsets"] = to_ndarray(std::move(arrays.offsets), {n + 1});
+    out["permutation"] = to_ndarray(std::move(arrays.permutation), {m});
+    out["duration"] = to_ndarray(std::move(arrays.duration), {n});
+    out["distance"] = to_ndarray(std::move(arrays.distance), {n});
+    out["num_trips"] = to_ndarray(std::move(arrays.num_trips), {n});
+
+    return out;
+}
+
+nb::dict nearest_arrays_to_py(NearestArrays&& arrays) {
+    const std::size_t n = arrays.size;
+    const std::size_t k = arrays.k;
+
+    auto column = [n, k](auto&& data) {
+        return k == 1 ? to_ndarray(std::move(data), {n}) : to_ndarray(std::move(data), {n, k});
+    };
+
+    nb::list names;
+    for(const auto& name : arrays.names) {
+        names.append(nb::str(name.c_str(), name.size()));
+    }
+
+    nb::dict out;
+    out["lon"] = column(std::move(arrays.lon));
+    out["lat"] = column(std::move(arrays.lat));
+    out["distance"] = column(std::move(arrays.distance));
+    out["name"] = column(std::move(arrays.name));
+    out["nodes"] = k == 1 ? to_ndarray(std::move(arrays.nodes), {n, 2}) : to_ndarray(std::move(arrays.nodes), {n, k, 2});
+    out["status"] = to_ndarray(std::move(arrays.status), {n});
+    out["names"] = names;
+    out["status_names"] = nb::make_tuple("Ok", "NoSegment", "InvalidValue", "InvalidOptions", "Error");
+
+    return out;
+}
+
+nb::dict pair_arrays_to_py(PairArrays&& arrays) {
+    const std::size_t n = arrays.size;
+
+    nb::dict out;
+    out["code"] = "Ok";
+    out["durations"] = arrays.has_durations ? nb::cast(to_ndarray(std::move(arrays.durations), {n})) : nb::none();
+    out["distances"] = arrays.has_distances ? nb::cast(to_ndarray(std::move(arrays.distances), {n})) : nb::none();
+    out["fallback_speed_cells"] = to_bool_ndarray(std::move(arrays.fallback_speed_cells), {n});
+    out["sub_tables"] = arrays.sub_tables;
+
+    return out;
+}
+
+} //namespace osrm_nb_util
@@ -0,0 +1,234 @@
+#include "utility/async_executor.h"
+
+#include <nanobind/nanobind.h>
+
+#include <cerrno>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#elif !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace nb = nanobind;
+
+namespace osrm_nb_util {
+
+AsyncExecutor::AsyncExecutor(ThreadPool& pool, std::size_t max_in_flight)
+    : pool(pool), limit(max_in_flight == 0 ? pool.size() : max_in_flight) {
+#if defined(__linux__)
+    read_fd = write_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(read_fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to create the async wakeup eventfd");
+    }
+#elif !defined(_WIN32)
+    int fds[2];
+    if(pipe(fds) != 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to create the async wakeup pipe");
+    }
+    for(int fd : fds) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    read_fd = fds[0];
+    write_fd = fds[1];
+#endif
+}
+
+AsyncExecutor::~AsyncExecutor() {
+    // The owner outlives every pending future, so only the tail of a task that already
+    // queued its completion can still be running here. On Windows that tail takes the GIL.
+    auto wait_idle = [this] {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return active_tasks == 0; });
+    };
+    if(PyGILState_Check()) {
+        nb::gil_scoped_release release;
+        wait_idle();
+    } else {
+        wait_idle();
+    }
+
+#if defined(__linux__)
+    close(read_fd);
+#elif !defined(_WIN32)
+    close(read_fd);
+    close(write_fd);
+#endif
+}
+
+nb::object AsyncExecutor::submit(nb::handle owner, Work work) {
+    nb::object running_loop = nb::module_::import_("asyncio").attr("get_running_loop")();
+
+    nb::object future;
+    std::uint64_t ticket;
+    {
+        nb::ft_lock_guard guard(py_mutex);
+        if(futures.empty()) {
+            // Bind to the caller's loop for as long as requests are pending. The callback holds
+            // the owner, so the engine can not go away underneath a running request.
+            loop = running_loop;
+            drain_callback = nb::cpp_function([this, keep = nb::borrow<nb::object>(owner)]() { drain(); });
+#ifndef _WIN32
+            loop.attr("add_reader")(read_fd, drain_callback);
+#endif
+        } else if(!loop.is(running_loop)) {
+            throw std::runtime_error("Async requests of an OSRM instance can not be spread over several event loops at once");
+        }
+
+        future = loop.attr("create_future")();
+        ticket = next_ticket++;
+        futures.emplace(ticket, future);
+    }
+
+    bool launch = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(running < limit) {
+            ++running;
+            ++active_tasks;
+            launch = true;
+        } else {
+            waiting.emplace_back(ticket, std::move(work));
+        }
+    }
+    if(launch) {
+        start(ticket, std::move(work));
+    }
+
+    return future;
+}
+
+void AsyncExecutor::start(std::uint64_t ticket, Work work) {
+    // A task keeps its slot and runs waiting requests until none are left
+    pool.submit([this, ticket, work = std::move(work)]() mutable {
+        while(true) {
+            Finisher finish;
+            try {
+                finish = work();
+            }
+            catch(...) {
+                finish = [error = std::current_exception()]() -> nb::object {
+                    std::rethrow_exception(error);
+                };
+            }
+            work = nullptr;
+
+            bool wake;
+            bool done = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                wake = completed.empty();
+                completed.push_back({ticket, std::move(finish)});
+
+                if(waiting.empty()) {
+                    --running;
+                    done = true;
+                } else {
+                    ticket = waiting.front().first;
+                    work = std::move(waiting.front().second);
+                    waiting.pop_front();
+                }
+            }
+            // One wakeup per batch, the loop drains everything queued until then
+            if(wake) {
+                notify();
+            }
+            if(done) {
+                break;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if(--active_tasks == 0) {
+            idle.notify_all();
+        }
+    });
+}
+
+void AsyncExecutor::notify() {
+#if defined(__linux__)
+    const std::uint64_t one = 1;
+    [[maybe_unused]] auto written = write(write_fd, &one, sizeof(one));
+#elif !defined(_WIN32)
+    // A full pipe already holds a pending wakeup
+    const char one = 1;
+    [[maybe_unused]] auto written = write(write_fd, &one, 1);
+#else
+    // The proactor loop has no add_reader, fall back to the loop's own thread-safe wakeup
+    nb::gil_scoped_acquire acquire;
+    nb::ft_lock_guard guard(py_mutex);
+    if(loop.is_valid()) {
+        try {
+            loop.attr("call_soon_threadsafe")(drain_callback);
+        }
+        catch(nb::python_error& e) {
+            e.discard_as_unraisable("osrm async wakeup");
+        }
+    }
+#endif
+}
+
+void AsyncExecutor::clear_wakeup() {
+#if defined(__linux__)
+    std::uint64_t count;
+    [[maybe_unused]] auto consumed = read(read_fd, &count, sizeof(count));
+#elif !defined(_WIN32)
+    char buf[64];
+    while(read(read_fd, buf, sizeof(buf)) > 0) {}
+#endif
+}
+
+void AsyncExecutor::drain() {
+    std::vector<Completion> batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        clear_wakeup();
+        batch.swap(completed);
+    }
+
+    // The futures are resolved outside of py_mutex, resolving them may run arbitrary Python code
+    std::vector<std::pair<nb::object, Finisher>> resolved;
+    {
+        nb::ft_lock_guard guard(py_mutex);
+        for(auto& completion : batch) {
+            auto itr = futures.find(completion.ticket);
+            if(itr == futures.end()) {
+                continue;
+            }
+            resolved.emplace_back(std::move(itr->second), std::move(completion.finish));
+            futures.erase(itr);
+        }
+    }
+
+    for(auto& [future, finish] : resolved) {
+        // Calling the finisher through nanobind translates C++ exceptions the same way as a synchronous call
+        try {
+            nb::object value = nb::cpp_function(std::move(finish))();
+            if(!nb::cast<bool>(future.attr("done")())) {
+                future.attr("set_result")(value);
+            }
+        }
+        catch(nb::python_error& e) {
+            if(!nb::cast<bool>(future.attr("done")())) {
+                future.attr("set_exception")(e.value());
+            }
+        }
+    }
+
+    nb::ft_lock_guard guard(py_mutex);
+    if(futures.empty() && loop.is_valid()) {
+#ifndef _WIN32
+        loop.attr("remove_reader")(read_fd);
+#endif
+        loop = nb::object();
+        drain_callback = nb::object();
+    }
+}
+
+} //namespace osrm_nb_util
@@ -0,0 +1,178 @@
+#include "utility/dataset_warmup.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <string>
+#include <system_error>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// The files StorageConfig loads, required and optional, appended to its base path
+const char* const dataset_files[] = {
+    ".osrm.ramIndex", ".osrm.fileIndex", ".osrm.edges", ".osrm.geometry", ".osrm.turn_weight_penalties",
+    ".osrm.turn_duration_penalties", ".osrm.datasource_names", ".osrm.names", ".osrm.timestamp",
+    ".osrm.properties", ".osrm.icd", ".osrm.maneuver_overrides", ".osrm.hsgr", ".osrm.nbg_nodes",
+    ".osrm.ebg_nodes", ".osrm.cells", ".osrm.cell_metrics", ".osrm.mldgr", ".osrm.tld", ".osrm.tls",
+    ".osrm.partition"
+};
+
+// Unit of work handed to the pool, small enough to spread a single large file over all workers
+constexpr std::size_t chunk_size = std::size_t(32) << 20;
+
+// Existing non-empty dataset files and their sizes
+void list_files(const std::filesystem::path& base_path, std::vector<std::string>& paths, std::vector<std::size_t>& sizes) {
+    for(const char* suffix : dataset_files) {
+        std::string path = base_path.string() + suffix;
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(path, ec);
+        if(!ec && size > 0) {
+            paths.push_back(std::move(path));
+            sizes.push_back(static_cast<std::size_t>(size));
+        }
+    }
+}
+
+struct Chunk {
+    std::size_t file;
+    std::size_t offset;
+    std::size_t size;
+};
+
+std::vector<Chunk> split(const std::vector<std::size_t>& sizes) {
+    std::vector<Chunk> chunks;
+    for(std::size_t f = 0; f < sizes.size(); ++f) {
+        for(std::size_t offset = 0; offset < sizes[f]; offset += chunk_size) {
+            chunks.push_back({ f, offset, std::min(chunk_size, sizes[f] - offset) });
+        }
+    }
+    return chunks;
+}
+
+} //namespace
+
+namespace osrm_nb_util {
+
+std::uint64_t dataset_bytes(const std::filesystem::path& base_path) {
+    std::vector<std::string> paths;
+    std::vector<std::size_t> sizes;
+    list_files(base_path, paths, sizes);
+
+    std::uint64_t bytes = 0;
+    for(std::size_t size : sizes) {
+        bytes += size;
+    }
+    return bytes;
+}
+
+DatasetWarmup::~DatasetWarmup() {
+    release();
+}
+
+void DatasetWarmup::release() {
+#ifndef _WIN32
+    for(const Mapping& mapping : locked) {
+        munmap(mapping.data, mapping.size);
+    }
+#endif
+    locked.clear();
+}
+
+WarmupReport DatasetWarmup::run(const std::filesystem::path& base_path, ThreadPool& pool, const WarmupOptions& options) {
+    std::lock_guard<std::mutex> guard(mutex);
+    release();
+
+    const auto start = std::chrono::steady_clock::now();
+    WarmupReport report;
+
+    std::vector<std::string> paths;
+    std::vector<std::size_t> sizes;
+    list_files(base_path, paths, sizes);
+    const std::vector<Chunk> chunks = split(sizes);
+
+#ifdef _WIN32
+    // No mmap here, reading the files through the OS cache warms it all the same
+    pool.parallel_for(chunks.size(), [&](std::size_t i) {
+        const Chunk& chunk = chunks[i];
+        std::ifstream file(paths[chunk.file], std::ios::binary);
+        file.seekg(static_cast<std::streamoff>(chunk.offset));
+        std::vector<char> buffer(std::min<std::size_t>(chunk.size, std::size_t(1) << 20));
+        for(std::size_t done = 0; done < chunk.size && file;) {
+            const std::size_t n = std::min(buffer.size(), chunk.size - done);
+            file.read(buffer.data(), static_cast<std::streamsize>(n));
+            done += n;
+        }
+    });
+#else
+    std::vector<Mapping> mappings;
+    bool huge_pages = options.huge_pages;
+    for(std::size_t f = 0; f < paths.size(); ++f) {
+        const int fd = open(paths[f].c_str(), O_RDONLY | O_CLOEXEC);
+        void* data = fd < 0 ? MAP_FAILED : mmap(nullptr, sizes[f], PROT_READ, MAP_SHARED, fd, 0);
+        const int error = errno;
+        if(fd >= 0) {
+            close(fd);
+        }
+        if(data == MAP_FAILED) {
+            for(const Mapping& mapping : mappings) {
+                munmap(mapping.data, mapping.size);
+            }
+            throw std::system_error(error, std::generic_category(), "Failed to map " + paths[f] + " for warm-up");
+        }
+        mappings.push_back({ data, sizes[f] });
+
+        madvise(data, sizes[f], MADV_WILLNEED);
+        if(options.huge_pages) {
+#ifdef MADV_HUGEPAGE
+            huge_pages = madvise(data, sizes[f], MADV_HUGEPAGE) == 0 && huge_pages;
+#else
+            huge_pages = false;
+#endif
+        }
+    }
+
+    // Reading one byte per page faults the whole file in, the checksum keeps the reads alive
+    const std::size_t page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::atomic<unsigned> checksum{0};
+    pool.parallel_for(chunks.size(), [&](std::size_t i) {
+        const Chunk& chunk = chunks[i];
+        const volatile unsigned char* bytes = static_cast<const unsigned char*>(mappings[chunk.file].data) + chunk.offset;
+        unsigned sum = 0;
+        for(std::size_t offset = 0; offset < chunk.size; offset += page_size) {
+            sum += bytes[offset];
+        }
+        checksum.fetch_xor(sum, std::memory_order_relaxed);
+    });
+
+    bool all_locked = options.lock;
+    for(const Mapping& mapping : mappings) {
+        // mlock fails beyond RLIMIT_MEMLOCK without privileges, the files then stay unlocked
+        if(options.lock && mlock(mapping.data, mapping.size) == 0) {
+            locked.push_back(mapping);
+        } else {
+            all_locked = false;
+            munmap(mapping.data, mapping.size);
+        }
+    }
+    report.huge_pages = huge_pages && !mappings.empty();
+    report.locked = all_locked && !mappings.empty();
+#endif
+
+    report.files = paths.size();
+    for(std::size_t size : sizes) {
+        report.bytes += size;
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+} //namespace osrm_nb_util
@@ -0,0 +1,44 @@
+#include "utility/engine_utility.h"
+
+#include "osrm/status.hpp"
+#include "engine/api/flatbuffers/fbresult_generated.h"
+#include "util/json_container.hpp"
+
+#include <string>
+#include <variant>
+
+namespace json = osrm::util::json;
+
+namespace osrm_nb_util {
+
+std::string status_code(osrm::engine::Status status, const json::Object& result) {
+    if(status == osrm::engine::Status::Ok) {
+        return "Ok";
+    }
+
+    auto itr = result.values.find("code");
+    if(itr == result.values.end() || !std::holds_alternative<json::String>(itr->second)) {
+        return "Error";
+    }
+
+    return std::get<json::String>(itr->second).value;
+}
+
+std::string status_code(osrm::engine::Status status, const flatbuffers::FlatBufferBuilder& result) {
+    if(status == osrm::engine::Status::Ok) {
+        return "Ok";
+    }
+
+    const auto* error = osrm::engine::api::fbresult::GetFBResult(result.GetBufferPointer())->code();
+    return (error && error->code()) ? error->code()->str() : "Error";
+}
+
+json::Object invalid_options_response(const std::string& message) {
+    json::Object result;
+    result.values["code"] = json::String("InvalidOptions");
+    result.values["message"] = json::String(message);
+
+    return result;
+}
+
+} //namespace osrm_nb_util
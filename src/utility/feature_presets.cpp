@@ -0,0 +1,98 @@
+#include "utility/feature_presets.h"
+
+#include "osrm/osrm.hpp"
+#include "utility/param_utility.h"
+
+#include <chrono>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#else
+#include <fstream>
+#include <unistd.h>
+#endif
+
+namespace osrm_nb_util {
+
+std::string feature_dataset_name(osrm::storage::FeatureDataset dataset) {
+    for(const auto& entry : feature_dataset_map) {
+        if(entry.second == dataset) {
+            return entry.first;
+        }
+    }
+    return std::string();
+}
+
+void set_disabled_features(osrm::engine::EngineConfig& config, const std::string& storage_path, const FeatureDatasets& disabled) {
+    config.disable_feature_dataset = { disabled.begin(), disabled.end() };
+    config.storage_config = osrm::storage::StorageConfig(storage_path, { disabled.begin(), disabled.end() });
+}
+
+std::uint64_t resident_bytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.WorkingSetSize;
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if(task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.resident_size;
+#else
+    // The second field of statm is the resident set in pages
+    std::ifstream statm("/proc/self/statm");
+    std::uint64_t size = 0;
+    std::uint64_t resident = 0;
+    if(!(statm >> size >> resident)) {
+        return 0;
+    }
+    return resident * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+std::vector<PresetReport> compare_feature_presets(osrm::engine::EngineConfig config,
+                                                  const std::string& storage_path,
+                                                  const std::vector<std::string>& presets) {
+    // Unknown presets fail before any dataset is loaded
+    for(const std::string& preset : presets) {
+        str_to_enum(preset, "Feature preset", feature_preset_map);
+    }
+
+    config.use_shared_memory = false;
+    config.use_mmap = false;
+
+    auto measure = [&](const std::string& preset) {
+        PresetReport report;
+        report.preset = preset;
+        report.disabled = str_to_enum(preset, "Feature preset", feature_preset_map);
+        set_disabled_features(config, storage_path, report.disabled);
+
+        const auto start = std::chrono::steady_clock::now();
+        const std::uint64_t before = resident_bytes();
+        {
+            const osrm::OSRM engine(config);
+            const std::uint64_t after = resident_bytes();
+            report.resident_bytes = after > before ? after - before : 0;
+        }
+        report.load_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return report;
+    };
+
+    const PresetReport full = measure("full");
+    std::vector<PresetReport> reports;
+    for(const std::string& preset : presets) {
+        PresetReport report = preset == full.preset ? full : measure(preset);
+        report.saved_bytes = static_cast<std::int64_t>(full.resident_bytes) - static_cast<std::int64_t>(report.resident_bytes);
+        reports.push_back(std::move(report));
+    }
+    return reports;
+}
+
+} //namespace osrm_nb_util
@@ -0,0 +1,218 @@
+#include "utility/hint_cache.h"
+
+#include "engine/api/flatbuffers/fbresult_generated.h"
+#include "util/coordinate.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <variant>
+
+namespace json = osrm::util::json;
+namespace fbresult = osrm::engine::api::fbresult;
+using osrm::engine::api::BaseParameters;
+using osrm::engine::api::RouteParameters;
+using osrm::engine::api::TableParameters;
+using osrm::engine::api::TripParameters;
+
+namespace {
+
+std::uint64_t exclude_hash(const BaseParameters& params) {
+    if(params.exclude.empty()) {
+        return 0;
+    }
+
+    std::vector<std::string> exclude = params.exclude;
+    std::sort(exclude.begin(), exclude.end());
+
+    std::string joined;
+    for(const auto& name : exclude) {
+        joined.append(name);
+        joined.push_back('\0');
+    }
+    return std::hash<std::string>{}(joined);
+}
+
+osrm_nb_util::SnapKey make_key(const BaseParameters& params, std::size_t i, std::uint64_t exclude) {
+    osrm_nb_util::SnapKey key;
+    key.lon = osrm::from_alias<std::int32_t>(params.coordinates[i].lon);
+    key.lat = osrm::from_alias<std::int32_t>(params.coordinates[i].lat);
+    key.snapping = static_cast<std::uint8_t>(params.snapping);
+    key.exclude = exclude;
+
+    if(!params.radiuses.empty() && params.radiuses[i]) {
+        key.has_radius = true;
+        key.radius = *params.radiuses[i];
+    }
+    if(!params.bearings.empty() && params.bearings[i]) {
+        key.has_bearing = true;
+        key.bearing = params.bearings[i]->bearing;
+        key.range = params.bearings[i]->range;
+    }
+    return key;
+}
+
+// Stores the hint of waypoint j < count, the snapped location of coordinate indices[j].
+// hint_at(j) returns the base64 hint of waypoint j, empty when it has none.
+template<typename HintAt>
+void store_hints(const BaseParameters& params,
+                 std::size_t count,
+                 HintAt&& hint_at,
+                 const std::vector<std::size_t>& indices,
+                 const std::vector<bool>& pending,
+                 osrm_nb_util::HintCache& cache)
+{
+    if(pending.empty() || !params.generate_hints) {
+        return;
+    }
+
+    count = std::min(count, indices.size());
+    const std::uint64_t exclude = exclude_hash(params);
+
+    for(std::size_t j = 0; j < count; ++j) {
+        const std::size_t i = indices[j];
+        if(i >= pending.size() || !pending[i]) {
+            continue;
+        }
+
+        const std::string hint = hint_at(j);
+        if(!hint.empty()) {
+            cache.put(make_key(params, i, exclude), osrm::engine::Hint::FromBase64(hint));
+        }
+    }
+}
+
+void harvest(const BaseParameters& params,
+             const json::Object& result,
+             const char* name,
+             const std::vector<std::size_t>& indices,
+             const std::vector<bool>& pending,
+             osrm_nb_util::HintCache& cache)
+{
+    auto itr = result.values.find(name);
+    if(itr == result.values.end()) {
+        return;
+    }
+
+    const auto& waypoints = std::get<json::Array>(itr->second).values;
+    store_hints(params, waypoints.size(), [&waypoints](std::size_t j) {
+        const auto& waypoint = std::get<json::Object>(waypoints[j]).values;
+        auto hint = waypoint.find("hint");
+        return hint == waypoint.end() ? std::string() : std::get<json::String>(hint->second).value;
+    }, indices, pending, cache);
+}
+
+void harvest(const BaseParameters& params,
+             const flatbuffers::Vector<flatbuffers::Offset<fbresult::Waypoint>>* waypoints,
+             const std::vector<std::size_t>& indices,
+             const std::vector<bool>& pending,
+             osrm_nb_util::HintCache& cache)
+{
+    if(waypoints == nullptr) {
+        return;
+    }
+
+    store_hints(params, waypoints->size(), [waypoints](std::size_t j) {
+        const auto* hint = waypoints->Get(j)->hint();
+        return hint == nullptr ? std::string() : hint->str();
+    }, indices, pending, cache);
+}
+
+std::vector<std::size_t> indices_or_all(const std::vector<std::size_t>& indices, std::size_t n) {
+    if(!indices.empty()) {
+        return indices;
+    }
+    std::vector<std::size_t> all(n);
+    std::iota(all.begin(), all.end(), 0);
+    return all;
+}
+
+} //namespace
+
+namespace osrm_nb_util {
+
+bool SnapKey::operator==(const SnapKey& other) const {
+    return lon == other.lon && lat == other.lat && snapping == other.snapping &&
+           has_radius == other.has_radius && radius == other.radius &&
+           has_bearing == other.has_bearing && bearing == other.bearing && range == other.range &&
+           exclude == other.exclude;
+}
+
+std::size_t SnapKeyHash::operator()(const SnapKey& key) const {
+    std::uint64_t radius_bits = 0;
+    std::memcpy(&radius_bits, &key.radius, sizeof(radius_bits));
+
+    std::uint64_t h = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(key.lon)) << 32) | static_cast<std::uint32_t>(key.lat);
+    const auto mix = [&h](std::uint64_t value) {
+        h ^= value + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+    };
+    mix(key.snapping);
+    mix(key.has_radius ? radius_bits : ~0ull);
+    mix(key.has_bearing ? (static_cast<std::uint64_t>(static_cast<std::uint16_t>(key.bearing)) << 16 | static_cast<std::uint16_t>(key.range)) : ~0ull);
+    mix(key.exclude);
+    return static_cast<std::size_t>(h);
+}
+
+std::vector<bool> fill_hints(BaseParameters& params, HintCache& cache) {
+    const std::size_t n = params.coordinates.size();
+    if(params.hints.empty()) {
+        params.hints.resize(n);
+    }
+
+    const std::uint64_t exclude = exclude_hash(params);
+    std::vector<bool> pending;
+    for(std::size_t i = 0; i < n; ++i) {
+        // Hints supplied by the caller are never replaced
+        if(params.hints[i]) {
+            continue;
+        }
+        if(auto hint = cache.get(make_key(params, i, exclude))) {
+            params.hints[i] = std::move(*hint);
+        }
+        else {
+            pending.resize(n);
+            pending[i] = true;
+        }
+    }
+    return pending;
+}
+
+void harvest_hints(const RouteParameters& params, const json::Object& result, const std::vector<bool>& pending, HintCache& cache) {
+    // With the waypoints option only the selected coordinates are reported
+    harvest(params, result, "waypoints", indices_or_all(params.waypoints, params.coordinates.size()), pending, cache);
+}
+
+void harvest_hints(const TableParameters& params, const json::Object& result, const std::vector<bool>& pending, HintCache& cache) {
+    const std::size_t n = params.coordinates.size();
+    harvest(params, result, "sources", indices_or_all(params.sources, n), pending, cache);
+    harvest(params, result, "destinations", indices_or_all(params.destinations, n), pending, cache);
+}
+
+void harvest_hints(const TripParameters& params, const json::Object& result, const std::vector<bool>& pending, HintCache& cache) {
+    // Trip reports its waypoints in input order
+    harvest(params, result, "waypoints", indices_or_all({}, params.coordinates.size()), pending, cache);
+}
+
+void harvest_hints(const RouteParameters& params, const flatbuffers::FlatBufferBuilder& result, const std::vector<bool>& pending, HintCache& cache) {
+    const auto* response = fbresult::GetFBResult(result.GetBufferPointer());
+    harvest(params, response->waypoints(), indices_or_all(params.waypoints, params.coordinates.size()), pending, cache);
+}
+
+void harvest_hints(const TableParameters& params, const flatbuffers::FlatBufferBuilder& result, const std::vector<bool>& pending, HintCache& cache) {
+    const std::size_t n = params.coordinates.size();
+    const auto* response = fbresult::GetFBResult(result.GetBufferPointer());
+    // The sources are the waypoints of the response, the destinations belong to its table
+    harvest(params, response->waypoints(), indices_or_all(params.sources, n), pending, cache);
+    if(response->table() != nullptr) {
+        harvest(params, response->table()->destinations(), indices_or_all(params.destinations, n), pending, cache);
+    }
+}
+
+void harvest_hints(const TripParameters& params, const flatbuffers::FlatBufferBuilder& result, const std::vector<bool>& pending, HintCache& cache) {
+    const auto* response = fbresult::GetFBResult(result.GetBufferPointer());
+    harvest(params, response->waypoints(), indices_or_all({}, params.coordinates.size()), pending, cache);
+}
+
+} //namespace osrm_nb_util
@@ -0,0 +1,275 @@
+#include "utility/input_utility.h"
+
+#include "engine/bearing.hpp"
+#include "engine/hint.hpp"
+#include "util/coordinate.hpp"
+
+#include <nanobind/nanobind.h>
+#include <nanobind/ndarray.h>
+#include <nanobind/stl/optional.h>
+#include <nanobind/stl/string.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace nb = nanobind;
+
+namespace {
+
+template<typename T>
+using Column = nb::ndarray<const T, nb::ndim<1>, nb::c_contig, nb::device::cpu>;
+
+template<typename T>
+using Pairs = nb::ndarray<const T, nb::shape<-1, 2>, nb::c_contig, nb::device::cpu>;
+
+// Lists and tuples go through the per-element path, anything exposing
+// the buffer protocol or DLPack is treated as an array
+bool is_array_like(nb::handle obj) {
+    return PyObject_CheckBuffer(obj.ptr()) || nb::hasattr(obj, "__dlpack__");
+}
+
+// dtype of an array-like object, read without converting it
+std::optional<nb::dlpack::dtype> array_dtype(nb::handle obj) {
+    nb::ndarray<> arr;
+    if(!nb::try_cast(obj, arr, false)) {
+        return std::nullopt;
+    }
+    return arr.dtype();
+}
+
+bool is_integer(nb::dlpack::dtype dtype) {
+    return dtype.code == static_cast<std::uint8_t>(nb::dlpack::dtype_code::Int) ||
+           dtype.code == static_cast<std::uint8_t>(nb::dlpack::dtype_code::UInt);
+}
+
+template<typename Array>
+Array cast_array(nb::handle obj, bool convert, const char* name, const char* shape) {
+    Array arr;
+    if(!nb::try_cast(obj, arr, convert)) {
+        throw std::invalid_argument(std::string(name) + " array must be numeric with shape " + shape);
+    }
+    return arr;
+}
+
+template<typename Out>
+std::vector<Out> to_unsigned(nb::handle obj, const char* name) {
+    std::vector<Out> out;
+
+    if(is_array_like(obj)) {
+        auto arr = cast_array<Column<std::int64_t>>(obj, true, name, "(N,)");
+        const std::int64_t* data = arr.data();
+        out.resize(arr.shape(0));
+
+        for(std::size_t i = 0; i < out.size(); ++i) {
+            if(data[i] < 0) {
+                throw std::invalid_argument(std::string(name) + " must be non-negative");
+            }
+            if(static_cast<std::uint64_t>(data[i]) > std::numeric_limits<Out>::max()) {
+                throw std::invalid_argument(std::string(name) + " must be at most " + std::to_string(std::numeric_limits<Out>::max()));
+            }
+            out[i] = static_cast<Out>(data[i]);
+        }
+        return out;
+    }
+
+    for(nb::handle h : nb::iter(obj)) {
+        out.push_back(nb::cast<Out>(h));
+    }
+    return out;
+}
+
+} //namespace
+
+namespace osrm_nb_util {
+
+std::vector<osrm::util::Coordinate> to_coordinates(nb::handle obj) {
+    std::vector<osrm::util::Coordinate> coordinates;
+
+    if(is_array_like(obj)) {
+        // int32 is fixed-point whatever its layout, other integers would be misread as degrees
+        const std::optional<nb::dlpack::dtype> dtype = array_dtype(obj);
+        if(dtype && *dtype == nb::dtype<std::int32_t>()) {
+            auto fixed = cast_array<Pairs<std::int32_t>>(obj, true, "coordinates", "(N, 2)");
+            const std::int32_t* data = fixed.data();
+            coordinates.reserve(fixed.shape(0));
+
+            for(std::size_t i = 0; i < fixed.shape(0); ++i) {
+                coordinates.emplace_back(osrm::util::FixedLongitude{data[i * 2]},
+                                         osrm::util::FixedLatitude{data[i * 2 + 1]});
+            }
+            return coordinates;
+        }
+        if(dtype && is_integer(*dtype)) {
+            throw std::invalid_argument("coordinates array of integers must be int32 fixed-point (degrees * 1e6)");
+        }
+
+        auto degrees = cast_array<Pairs<double>>(obj, true, "coordinates", "(N, 2)");
+        const double* data = degrees.data();
+        coordinates.reserve(degrees.shape(0));
+
+        for(std::size_t i = 0; i < degrees.shape(0); ++i) {
+            // NaN/inf can not be converted to fixed-point, the default Coordinate is invalid instead
+            if(!std::isfinite(data[i * 2]) || !std::isfinite(data[i * 2 + 1])) {
+                coordinates.emplace_back();
+                continue;
+            }
+            coordinates.emplace_back(osrm::util::FloatLongitude{data[i * 2]},
+                                     osrm::util::FloatLatitude{data[i * 2 + 1]});
+        }
+        return coordinates;
+    }
+
+    for(nb::handle h : nb::iter(obj)) {
+        if(nb::isinstance<nb::tuple>(h)) {
+            auto tup = nb::tuple(h);
+            if(tup.size() != 2) throw std::runtime_error("Coordinate tuple must have length 2");
+            double lon = nb::cast<double>(tup[0]);
+            double lat = nb::cast<double>(tup[1]);
+            coordinates.emplace_back(osrm::util::FloatLongitude{lon}, osrm::util::FloatLatitude{lat});
+        } else {
+            coordinates.push_back(nb::cast<osrm::util::Coordinate>(h));
+        }
+    }
+    return coordinates;
+}
+
+std::vector<std::optional<double>> to_radiuses(nb::handle obj) {
+    std::vector<std::optional<double>> radiuses;
+
+    if(is_array_like(obj)) {
+        auto arr = cast_array<Column<double>>(obj, true, "radiuses", "(N,)");
+        const double* data = arr.data();
+        radiuses.resize(arr.shape(0));
+
+        for(std::size_t i = 0; i < radiuses.size(); ++i) {
+            if(!std::isnan(data[i])) {
+                radiuses[i] = data[i];
+            }
+        }
+        return radiuses;
+    }
+
+    for(nb::handle h : nb::iter(obj)) {
+        if(h.is_none()) {
+            radiuses.emplace_back();
+        } else {
+            double radius = nb::cast<double>(h);
+            radiuses.push_back(std::isnan(radius) ? std::optional<double>() : radius);
+        }
+    }
+    return radiuses;
+}
+
+std::vector<std::optional<osrm::engine::Bearing>> to_bearings(nb::handle obj) {
+    std::vector<std::optional<osrm::engine::Bearing>> bearings;
+
+    if(is_array_like(obj)) {
+        Pairs<std::int16_t> exact;
+        if(nb::try_cast(obj, exact, false)) {
+            const std::int16_t* data = exact.data();
+            bearings.resize(exact.shape(0));
+
+            for(std::size_t i = 0; i < bearings.size(); ++i) {
+                if(data[i * 2] >= 0) {
+                    bearings[i] = osrm::engine::Bearing{data[i * 2], data[i * 2 + 1]};
+                }
+            }
+            return bearings;
+        }
+
+        // Other dtypes go through double, so that fractions and values beyond int16 raise instead of being truncated
+        auto arr = cast_array<Pairs<double>>(obj, true, "bearings", "(N, 2)");
+        const double* data = arr.data();
+        bearings.resize(arr.shape(0));
+
+        for(std::size_t i = 0; i < bearings.size() * 2; ++i) {
+            if(std::isnan(data[i]) && i % 2 == 0) {
+                continue;
+            }
+            if(!(data[i] == std::trunc(data[i]) && data[i] >= std::numeric_limits<std::int16_t>::min() &&
+                 data[i] <= std::numeric_limits<std::int16_t>::max())) {
+                throw std::invalid_argument("bearings must be integers within int16");
+            }
+        }
+        for(std::size_t i = 0; i < bearings.size(); ++i) {
+            if(data[i * 2] >= 0) {
+                bearings[i] = osrm::engine::Bearing{static_cast<std::int16_t>(data[i * 2]), static_cast<std::int16_t>(data[i * 2 + 1])};
+            }
+        }
+        return bearings;
+    }
+
+    for(nb::handle h : nb::iter(obj)) {
+        bearings.push_back(nb::cast<std::optional<osrm::engine::Bearing>>(h));
+    }
+    return bearings;
+}
+
+std::vector<std::size_t> to_indices(nb::handle obj, const char* name) {
+    return to_unsigned<std::size_t>(obj, name);
+}
+
+std::vector<std::pair<std::size_t, std::size_t>> to_index_pairs(nb::handle obj, const char* name) {
+    std::vector<std::pair<std::size_t, std::size_t>> pairs;
+
+    if(is_array_like(obj)) {
+        auto arr = cast_array<Pairs<std::int64_t>>(obj, true, name, "(N, 2)");
+        const std::int64_t* data = arr.data();
+        pairs.resize(arr.shape(0));
+
+        for(std::size_t i = 0; i < pairs.size(); ++i) {
+            if(data[i * 2] < 0 || data[i * 2 + 1] < 0) {
+                throw std::invalid_argument(std::string(name) + " must be non-negative");
+            }
+            pairs[i] = { static_cast<std::size_t>(data[i * 2]), static_cast<std::size_t>(data[i * 2 + 1]) };
+        }
+        return pairs;
+    }
+
+    for(nb::handle h : nb::iter(obj)) {
+        auto pair = nb::cast<nb::sequence>(h);
+        if(nb::len(pair) != 2) {
+            throw std::invalid_argument(std::string(name) + " must hold (source, destination) pairs");
+        }
+        pairs.emplace_back(nb::cast<std::size_t>(pair[0]), nb::cast<std::size_t>(pair[1]));
+    }
+    return pairs;
+}
+
+std::vector<unsigned> to_timestamps(nb::handle obj) {
+    return to_unsigned<unsigned>(obj, "timestamps");
+}
+
+std::vector<std::optional<osrm::engine::Hint>> to_hints(nb::handle obj) {
+    std::vector<std::optional<osrm::engine::Hint>> hints;
+
+    for(nb::handle h : nb::iter(obj)) {
+        if(h.is_none()) {
+            hints.emplace_back();
+            continue;
+        }
+        if(!nb::isinstance<nb::str>(h)) {
+            hints.push_back(nb::cast<std::optional<osrm::engine::Hint>>(h));
+            continue;
+        }
+
+        // Decoding reads whole segment hints, a truncated string would be read past its end
+        const std::string encoded = nb::cast<std::string>(h);
+        if(encoded.empty() || encoded.size() % osrm::engine::ENCODED_SEGMENT_HINT_SIZE != 0) {
+            throw std::invalid_argument("hints must be base64 strings taken from a response");
+        }
+        try {
+            hints.push_back(osrm::engine::Hint::FromBase64(encoded));
+        }
+        catch(const std::exception&) {
+            throw std::invalid_argument("hints must be base64 strings taken from a response");
+        }
+    }
+    return hints;
+}
+
+} //namespace osrm_nb_util
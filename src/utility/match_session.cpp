@@ -0,0 +1,227 @@
+#include "utility/match_session.h"
+
+#include "osrm/status.hpp"
+
+#include "utility/engine_utility.h"
+#include "utility/osrm_utility.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace json = osrm::util::json;
+using osrm::engine::api::MatchParameters;
+
+namespace {
+
+const json::Object* as_object(const json::Value& value) {
+    return std::get_if<json::Object>(&value);
+}
+
+std::size_t get_index(const json::Object& obj, const char* key) {
+    return static_cast<std::size_t>(std::get<json::Number>(obj.values.at(key)).value);
+}
+
+} //namespace
+
+namespace osrm_nb_util {
+
+MatchSession::MatchSession(std::shared_ptr<const osrm::OSRM> engine, const MatchParameters& template_params, std::size_t window, std::size_t overlap)
+    : engine(std::move(engine)),
+      keep_hints(template_params.generate_hints),
+      window(window),
+      overlap(overlap)
+{
+    if(window < overlap + 2) {
+        throw std::invalid_argument("window must exceed overlap by at least 2 points");
+    }
+
+    // Only the shared settings are kept, the anchor needs the hints of every window
+    options.exclude = template_params.exclude;
+    options.snapping = template_params.snapping;
+    options.steps = template_params.steps;
+    options.annotations = template_params.annotations;
+    options.annotations_type = template_params.annotations_type;
+    options.geometries = template_params.geometries;
+    options.overview = template_params.overview;
+    options.gaps = template_params.gaps;
+    options.tidy = template_params.tidy;
+    options.generate_hints = true;
+}
+
+json::Object MatchSession::push(const std::vector<Point>& points) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::optional<bool> timestamps = has_timestamps;
+    for(const Point& point : points) {
+        if(!timestamps) {
+            timestamps = point.timestamp.has_value();
+        }
+        if(*timestamps != point.timestamp.has_value()) {
+            throw std::invalid_argument("Either every point of a session has a timestamp or none has");
+        }
+    }
+    has_timestamps = timestamps;
+
+    json::Array tracepoints;
+    json::Array legs;
+    for(const Point& point : points) {
+        buffer.push_back(Buffered{point, next_index++});
+        if(buffer.size() >= window) {
+            match_window(false, tracepoints, legs);
+        }
+    }
+
+    json::Object out;
+    out.values["tracepoints"] = std::move(tracepoints);
+    out.values["legs"] = std::move(legs);
+    return out;
+}
+
+json::Object MatchSession::finish() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    json::Array tracepoints;
+    json::Array legs;
+    if(buffer.size() > (anchor_hint ? 1u : 0u)) {
+        match_window(true, tracepoints, legs);
+    }
+    buffer.clear();
+    anchor_hint.reset();
+    has_timestamps.reset();
+
+    json::Object out;
+    out.values["tracepoints"] = std::move(tracepoints);
+    out.values["legs"] = std::move(legs);
+    return out;
+}
+
+std::size_t MatchSession::pending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return buffer.size() - (anchor_hint ? 1 : 0);
+}
+
+void MatchSession::match_window(bool flush, json::Array& out_tracepoints, json::Array& out_legs) {
+    const std::size_t n = buffer.size();
+    const bool anchored = anchor_hint.has_value();
+
+    MatchParameters params = options;
+    params.coordinates.reserve(n);
+    for(const Buffered& entry : buffer) {
+        params.coordinates.push_back(entry.point.coordinate);
+        if(*has_timestamps) params.timestamps.push_back(*entry.point.timestamp);
+        params.radiuses.push_back(entry.point.radius);
+        params.bearings.push_back(entry.point.bearing);
+    }
+    params.hints.resize(n);
+    params.hints[0] = anchor_hint;
+
+    // A window without any matchable point is not an error of the session
+    json::Object result;
+    if(n >= 2) {
+        const osrm::engine::Status status = engine->Match(params, result);
+        const std::string code = status_code(status, result);
+        if(code != "Ok" && code != "NoMatch" && code != "NoSegment") {
+            check_status(status, result);
+        }
+    }
+
+    const std::size_t final_end = flush ? n : n - overlap;
+    const std::size_t first = anchored ? 1 : 0;
+
+    static const json::Array no_values;
+    auto find_array = [&result](const char* key) -> const json::Array& {
+        auto itr = result.values.find(key);
+        return itr == result.values.end() ? no_values : std::get<json::Array>(itr->second);
+    };
+    const json::Array& tracepoints = find_array("tracepoints");
+    const json::Array& matchings = find_array("matchings");
+
+    // Window matchings take over the id of the anchor they continue, the others get new ids
+    std::unordered_map<std::size_t, std::uint64_t> matching_ids;
+    auto matching_id = [&](std::size_t j) {
+        auto [itr, inserted] = matching_ids.try_emplace(j, 0);
+        if(inserted) {
+            itr->second = next_matching++;
+        }
+        return itr->second;
+    };
+    if(anchored && !tracepoints.values.empty()) {
+        if(const json::Object* tracepoint = as_object(tracepoints.values[0])) {
+            matching_ids[get_index(*tracepoint, "matchings_index")] = anchor_matching;
+        }
+    }
+
+    // Window point of every (matching, waypoint index)
+    std::unordered_map<std::size_t, std::unordered_map<std::size_t, std::size_t>> waypoints;
+    for(std::size_t i = 0; i < tracepoints.values.size() && i < final_end; ++i) {
+        if(const json::Object* tracepoint = as_object(tracepoints.values[i])) {
+            waypoints[get_index(*tracepoint, "matchings_index")][get_index(*tracepoint, "waypoint_index")] = i;
+        }
+    }
+
+    for(std::size_t i = first; i < final_end; ++i) {
+        const json::Object* tracepoint = i < tracepoints.values.size() ? as_object(tracepoints.values[i]) : nullptr;
+        if(tracepoint == nullptr) {
+            out_tracepoints.values.push_back(json::Null());
+            continue;
+        }
+
+        json::Object copy = *tracepoint;
+        copy.values["matchings_index"] = json::Number(static_cast<double>(matching_id(get_index(*tracepoint, "matchings_index"))));
+        copy.values["index"] = json::Number(static_cast<double>(buffer[i].index));
+        if(!keep_hints) {
+            copy.values.erase("hint");
+        }
+        out_tracepoints.values.push_back(std::move(copy));
+    }
+
+    // Leg k of a matching joins its waypoints k and k + 1, it is final once both of them are
+    std::vector<std::pair<std::size_t, json::Object>> final_legs;
+    for(const auto& [j, points] : waypoints) {
+        if(j >= matchings.values.size()) {
+            continue;
+        }
+        const json::Object& matching = std::get<json::Object>(matchings.values[j]);
+        const json::Array& matching_legs = std::get<json::Array>(matching.values.at("legs"));
+
+        for(const auto& [k, from] : points) {
+            auto to = points.find(k + 1);
+            if(to == points.end() || k >= matching_legs.values.size()) {
+                continue;
+            }
+
+            json::Object leg = std::get<json::Object>(matching_legs.values[k]);
+            leg.values["matching"] = json::Number(static_cast<double>(matching_id(j)));
+            leg.values["from"] = json::Number(static_cast<double>(buffer[from].index));
+            leg.values["to"] = json::Number(static_cast<double>(buffer[to->second].index));
+            final_legs.emplace_back(from, std::move(leg));
+        }
+    }
+
+    std::sort(final_legs.begin(), final_legs.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    for(auto& leg : final_legs) {
+        out_legs.values.push_back(std::move(leg.second));
+    }
+
+    // The last final point anchors the next window if it was matched
+    anchor_hint.reset();
+    std::size_t drop = final_end;
+    if(!flush && final_end > 0 && final_end - 1 < tracepoints.values.size()) {
+        if(const json::Object* last = as_object(tracepoints.values[final_end - 1])) {
+            auto hint = last->values.find("hint");
+            if(hint != last->values.end()) {
+                anchor_hint = osrm::engine::Hint::FromBase64(std::get<json::String>(hint->second).value);
+                anchor_matching = matching_id(get_index(*last, "matchings_index"));
+                drop = final_end - 1;
+            }
+        }
+    }
+    buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(drop));
+}
+
+} //namespace osrm_nb_util
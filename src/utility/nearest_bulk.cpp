@@ -0,0 +1,184 @@
+#include "utility/nearest_bulk.h"
+
+#include "osrm/status.hpp"
+#include "util/json_container.hpp"
+
+#include "utility/engine_utility.h"
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <variant>
+
+namespace json = osrm::util::json;
+using osrm::engine::api::NearestParameters;
+using osrm_nb_util::NearestStatus;
+
+namespace {
+
+// Points per task, each chunk collects its street names locally before they are merged
+constexpr std::size_t chunk_size = 1024;
+
+NearestStatus to_nearest_status(const std::string& code) {
+    if(code == "NoSegment") return NearestStatus::NoSegment;
+    if(code == "InvalidValue") return NearestStatus::InvalidValue;
+    if(code == "InvalidOptions") return NearestStatus::InvalidOptions;
+    return NearestStatus::Error;
+}
+
+double number_or_nan(const json::Object& obj, const char* key) {
+    auto itr = obj.values.find(key);
+    if(itr == obj.values.end() || !std::holds_alternative<json::Number>(itr->second)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return std::get<json::Number>(itr->second).value;
+}
+
+// Street names of one chunk, deduplicated within the chunk
+struct ChunkNames {
+    std::vector<std::string> names;
+    std::unordered_map<std::string, std::int32_t> index;
+
+    std::int32_t add(const std::string& name) {
+        auto [itr, inserted] = index.try_emplace(name, static_cast<std::int32_t>(names.size()));
+        if(inserted) {
+            names.push_back(name);
+        }
+        return itr->second;
+    }
+};
+
+// Writes the waypoints of a Nearest response into the k slots of point i
+void copy_waypoints(const json::Object& result, std::size_t i, osrm_nb_util::NearestArrays& arrays, ChunkNames& names) {
+    auto waypoints = result.values.find("waypoints");
+    if(waypoints == result.values.end()) {
+        return;
+    }
+
+    const auto& values = std::get<json::Array>(waypoints->second).values;
+    for(std::size_t j = 0; j < values.size() && j < arrays.k; ++j) {
+        const auto& waypoint = std::get<json::Object>(values[j]);
+        const std::size_t slot = i * arrays.k + j;
+
+        auto location = waypoint.values.find("location");
+        if(location != waypoint.values.end()) {
+            const auto& lonlat = std::get<json::Array>(location->second).values;
+            arrays.lon[slot] = std::get<json::Number>(lonlat[0]).value;
+            arrays.lat[slot] = std::get<json::Number>(lonlat[1]).value;
+        }
+        arrays.distance[slot] = number_or_nan(waypoint, "distance");
+
+        auto name = waypoint.values.find("name");
+        if(name != waypoint.values.end() && std::holds_alternative<json::String>(name->second)) {
+            arrays.name[slot] = names.add(std::get<json::String>(name->second).value);
+        }
+
+        auto nodes = waypoint.values.find("nodes");
+        if(nodes != waypoint.values.end()) {
+            const auto& pair = std::get<json::Array>(nodes->second).values;
+            for(std::size_t n = 0; n < pair.size() && n < 2; ++n) {
+                arrays.nodes[slot * 2 + n] = static_cast<std::uint64_t>(std::get<json::Number>(pair[n]).value);
+            }
+        }
+    }
+}
+
+} //namespace
+
+namespace osrm_nb_util {
+
+NearestArrays run_nearest_bulk(const osrm::OSRM& engine,
+                               ThreadPool& pool,
+                               const NearestParameters& options,
+                               const std::vector<osrm::util::Coordinate>& coordinates,
+                               const std::vector<std::optional<double>>& radiuses,
+                               const std::vector<std::optional<osrm::engine::Bearing>>& bearings,
+                               std::size_t k)
+{
+    const std::size_t n = coordinates.size();
+    k = std::max<std::size_t>(k, 1);
+
+    NearestArrays arrays;
+    arrays.size = n;
+    arrays.k = k;
+    arrays.lon.assign(n * k, std::numeric_limits<double>::quiet_NaN());
+    arrays.lat.assign(n * k, std::numeric_limits<double>::quiet_NaN());
+    arrays.distance.assign(n * k, std::numeric_limits<double>::quiet_NaN());
+    arrays.name.assign(n * k, -1);
+    arrays.nodes.assign(n * k * 2, 0);
+    arrays.status.assign(n, static_cast<std::uint8_t>(NearestStatus::Ok));
+
+    NearestParameters point_template;
+    point_template.exclude = options.exclude;
+    point_template.snapping = options.snapping;
+    point_template.number_of_results = static_cast<unsigned>(k);
+    point_template.generate_hints = false;
+
+    const std::size_t num_chunks = (n + chunk_size - 1) / chunk_size;
+    std::vector<ChunkNames> chunk_names(num_chunks);
+
+    pool.parallel_for(num_chunks, [&](std::size_t chunk) {
+        ChunkNames& names = chunk_names[chunk];
+        NearestParameters params = point_template;
+
+        const std::size_t end = std::min(n, (chunk + 1) * chunk_size);
+        for(std::size_t i = chunk * chunk_size; i < end; ++i) {
+            if(!coordinates[i].IsValid()) {
+                arrays.status[i] = static_cast<std::uint8_t>(NearestStatus::InvalidValue);
+                continue;
+            }
+
+            params.coordinates = {coordinates[i]};
+            if(!radiuses.empty()) params.radiuses = {radiuses[i]};
+            if(!bearings.empty()) params.bearings = {bearings[i]};
+
+            if(!params.IsValid()) {
+                arrays.status[i] = static_cast<std::uint8_t>(NearestStatus::InvalidOptions);
+                continue;
+            }
+
+            json::Object result;
+            try {
+                const osrm::engine::Status status = engine.Nearest(params, result);
+                if(status != osrm::engine::Status::Ok) {
+                    arrays.status[i] = static_cast<std::uint8_t>(to_nearest_status(status_code(status, result)));
+                    continue;
+                }
+            }
+            catch(const std::exception&) {
+                arrays.status[i] = static_cast<std::uint8_t>(NearestStatus::Error);
+                continue;
+            }
+
+            copy_waypoints(result, i, arrays, names);
+        }
+    });
+
+    // Merge the per-chunk names and remap the name column to the merged list
+    ChunkNames merged;
+    for(std::size_t chunk = 0; chunk < num_chunks; ++chunk) {
+        const auto& local = chunk_names[chunk].names;
+        if(local.empty()) {
+            continue;
+        }
+
+        std::vector<std::int32_t> remap(local.size());
+        for(std::size_t j = 0; j < local.size(); ++j) {
+            remap[j] = merged.add(local[j]);
+        }
+
+        const std::size_t end = std::min(n, (chunk + 1) * chunk_size) * k;
+        for(std::size_t slot = chunk * chunk_size * k; slot < end; ++slot) {
+            if(arrays.name[slot] >= 0) {
+                arrays.name[slot] = remap[arrays.name[slot]];
+            }
+        }
+    }
+    arrays.names = std::move(merged.names);
+
+    return arrays;
+}
+
+} //namespace osrm_nb_util
@@ -3,14 +3,18 @@
 #include "osrm/osrm.hpp"
 #include "osrm/engine_config.hpp"
 #include "osrm/status.hpp"
+#include "engine/api/flatbuffers/fbresult_generated.h"
 
 #include "engineconfig_nb.h"
+#include "utility/feature_presets.h"
 #include "utility/param_utility.h"
 
 #include <nanobind/nanobind.h>
 #include <nanobind/stl/string.h>
+#include <nanobind/stl/vector.h>
 
 #include <filesystem>
+#include <optional>
 
 #include <unordered_map>
 #include <stdexcept>
@@ -44,12 +48,43 @@ void check_status(osrm::engine::Status status, osrm::util::json::Object& res) {
     throw std::runtime_error(code + " - " + msg);
 }
 
-void populate_cfg_from_kwargs(const nb::kwargs& kwargs, EngineConfig& config) {
+void check_status(osrm::engine::Status status, const flatbuffers::FlatBufferBuilder& res) {
+    if(status == osrm::engine::Status::Ok) {
+        return;
+    }
+
+    const auto* fb_result = osrm::engine::api::fbresult::GetFBResult(res.GetBufferPointer());
+    const auto* error = fb_result->code();
+
+    const std::string code = (error && error->code()) ? error->code()->str() : "Error";
+    const std::string msg = (error && error->message()) ? error->message()->str() : "";
+
+    throw std::runtime_error(code + " - " + msg);
+}
+
+void populate_cfg_from_kwargs(const nb::dict& kwargs, EngineConfig& config) {
+    // The storage config is built after every kwarg was read, as it depends on the disabled feature datasets
+    std::optional<std::string> storage_path;
+    osrm_nb_util::FeatureDatasets disabled;
+
     std::unordered_map<std::string, std::function<void(const std::pair<nb::handle, nb::handle>&)>> assign_map {
-        { "storage_config", [&config](const std::pair<nb::handle, nb::handle>& val) {
+        { "storage_config", [&storage_path](const std::pair<nb::handle, nb::handle>& val) {
+            std::string str;
+            assign_val(str, val);
+            storage_path = str;
+        } },
+        { "disable_feature_dataset", [&disabled](const std::pair<nb::handle, nb::handle>& val) {
+            std::vector<std::string> names;
+            assign_val(names, val);
+            for(const std::string& name : names) {
+                disabled.push_back(osrm_nb_util::str_to_enum(name, "FeatureDataset", osrm_nb_util::feature_dataset_map));
+            }
+        } },
+        { "feature_preset", [&disabled](const std::pair<nb::handle, nb::handle>& val) {
             std::string str;
             assign_val(str, val);
-            config.storage_config = osrm::storage::StorageConfig(str);
+            const auto preset = osrm_nb_util::str_to_enum(str, "Feature preset", osrm_nb_util::feature_preset_map);
+            disabled.insert(disabled.end(), preset.begin(), preset.end());
         } },
         { "max_locations_trip", [&config](const std::pair<nb::handle, nb::handle>& val) {
             assign_val(config.max_locations_trip, val);
@@ -120,6 +155,13 @@ void populate_cfg_from_kwargs(const nb::kwargs& kwargs, EngineConfig& config) {
         
         itr->second(kwarg);
     }
+
+    if(storage_path) {
+        osrm_nb_util::set_disabled_features(config, *storage_path, disabled);
+    } else {
+        // A shared memory dataset is loaded by osrm-datastore, which decides what it holds
+        config.disable_feature_dataset = { disabled.begin(), disabled.end() };
+    }
 }
 
 } //namespace osrm_nb_util
@@ -0,0 +1,239 @@
+#include "utility/pair_table.h"
+
+#include "util/coordinate.hpp"
+#include "util/json_container.hpp"
+
+#include "utility/osrm_utility.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace json = osrm::util::json;
+using osrm::engine::api::TableParameters;
+
+namespace {
+
+// One sub-Table: the coordinates of the grouping side and the partners they are paired with
+struct Group {
+    std::vector<std::size_t> keys;
+    std::vector<std::size_t> partners; // sorted
+    std::size_t wanted = 0;            // cells of keys x partners that some pair asks for
+};
+
+std::vector<std::size_t> sorted_union(const std::vector<std::size_t>& a, const std::vector<std::size_t>& b) {
+    std::vector<std::size_t> out;
+    out.reserve(a.size() + b.size());
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+    return out;
+}
+
+} //namespace
+
+namespace osrm_nb_util {
+
+std::vector<IndexPair> pairs_from_arrays(const std::vector<osrm::util::Coordinate>& origins,
+                                         const std::vector<osrm::util::Coordinate>& destinations,
+                                         std::vector<osrm::util::Coordinate>& coordinates)
+{
+    if(origins.size() != destinations.size()) {
+        throw std::invalid_argument("origins and destinations must have the same length");
+    }
+
+    std::unordered_map<std::uint64_t, std::size_t> index;
+    auto add = [&](const osrm::util::Coordinate& coordinate) {
+        const std::uint64_t key = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(osrm::from_alias<std::int32_t>(coordinate.lon))) << 32)
+                                | static_cast<std::uint32_t>(osrm::from_alias<std::int32_t>(coordinate.lat));
+        const auto [itr, inserted] = index.emplace(key, coordinates.size());
+        if(inserted) {
+            coordinates.push_back(coordinate);
+        }
+        return itr->second;
+    };
+
+    std::vector<IndexPair> pairs;
+    pairs.reserve(origins.size());
+    for(std::size_t i = 0; i < origins.size(); ++i) {
+        const std::size_t origin = add(origins[i]);
+        pairs.emplace_back(origin, add(destinations[i]));
+    }
+    return pairs;
+}
+
+PairArrays run_pair_table(const osrm::OSRM& engine,
+                          ThreadPool& pool,
+                          const TableParameters& params,
+                          const std::vector<IndexPair>& pairs,
+                          std::size_t block_size,
+                          int max_locations)
+{
+    const std::size_t n = params.coordinates.size();
+    for(const IndexPair& pair : pairs) {
+        if(pair.first >= n || pair.second >= n) {
+            throw std::invalid_argument("pairs must index the coordinates of table_params");
+        }
+    }
+
+    block_size = table_block_size(block_size, max_locations);
+
+    // Group by the side with fewer distinct coordinates, which gives fewer and wider sub-Tables
+    std::size_t num_sources = 0;
+    std::size_t num_destinations = 0;
+    {
+        std::vector<char> is_source(n, 0);
+        std::vector<char> is_destination(n, 0);
+        for(const IndexPair& pair : pairs) {
+            num_sources += !is_source[pair.first];
+            num_destinations += !is_destination[pair.second];
+            is_source[pair.first] = 1;
+            is_destination[pair.second] = 1;
+        }
+    }
+    const bool by_source = num_sources <= num_destinations;
+    auto key_of = [by_source](const IndexPair& pair) { return by_source ? pair.first : pair.second; };
+    auto partner_of = [by_source](const IndexPair& pair) { return by_source ? pair.second : pair.first; };
+
+    std::vector<std::vector<std::size_t>> partners(n);
+    std::vector<std::vector<std::size_t>> pairs_of_key(n);
+    for(std::size_t p = 0; p < pairs.size(); ++p) {
+        partners[key_of(pairs[p])].push_back(partner_of(pairs[p]));
+        pairs_of_key[key_of(pairs[p])].push_back(p);
+    }
+
+    // Keys wanting the same partners share a group. The map orders the groups by their partners,
+    // so that groups with overlapping partners are adjacent when they are packed below.
+    std::map<std::vector<std::size_t>, std::vector<std::size_t>> keys_by_partners;
+    for(std::size_t key = 0; key < n; ++key) {
+        std::vector<std::size_t>& wanted = partners[key];
+        if(wanted.empty()) {
+            continue;
+        }
+        std::sort(wanted.begin(), wanted.end());
+        wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+        keys_by_partners[std::move(wanted)].push_back(key);
+    }
+
+    // Adjacent groups are merged into one sub-Table while at least half of its cells are wanted
+    std::vector<Group> blocks;
+    Group current;
+    for(const auto& [group_partners, keys] : keys_by_partners) {
+        const std::size_t group_wanted = keys.size() * group_partners.size();
+
+        // A group beyond the block size is split into full sub-Tables of its own
+        if(keys.size() > block_size || group_partners.size() > block_size) {
+            for(std::size_t k = 0; k < keys.size(); k += block_size) {
+                for(std::size_t p = 0; p < group_partners.size(); p += block_size) {
+                    Group chunk;
+                    chunk.keys.assign(keys.begin() + k, keys.begin() + std::min(k + block_size, keys.size()));
+                    chunk.partners.assign(group_partners.begin() + p, group_partners.begin() + std::min(p + block_size, group_partners.size()));
+                    chunk.wanted = chunk.keys.size() * chunk.partners.size();
+                    blocks.push_back(std::move(chunk));
+                }
+            }
+            continue;
+        }
+
+        std::vector<std::size_t> merged = sorted_union(current.partners, group_partners);
+        const std::size_t num_keys = current.keys.size() + keys.size();
+        if(!current.keys.empty() &&
+           (num_keys > block_size || merged.size() > block_size || 2 * (current.wanted + group_wanted) < num_keys * merged.size())) {
+            blocks.push_back(std::move(current));
+            current = Group();
+            merged = group_partners;
+        }
+        current.keys.insert(current.keys.end(), keys.begin(), keys.end());
+        current.partners = std::move(merged);
+        current.wanted += group_wanted;
+    }
+    if(!current.keys.empty()) {
+        blocks.push_back(std::move(current));
+    }
+
+    PairArrays arrays;
+    arrays.size = pairs.size();
+    arrays.sub_tables = blocks.size();
+    arrays.has_durations = has_annotation(params.annotations, TableParameters::AnnotationsType::Duration);
+    arrays.has_distances = has_annotation(params.annotations, TableParameters::AnnotationsType::Distance);
+    if(arrays.has_durations) {
+        arrays.durations.assign(arrays.size, std::numeric_limits<double>::quiet_NaN());
+    }
+    if(arrays.has_distances) {
+        arrays.distances.assign(arrays.size, std::numeric_limits<double>::quiet_NaN());
+    }
+    arrays.fallback_speed_cells.assign(arrays.size, 0);
+
+    // Shared options of every sub-Table, the per-coordinate vectors are filled per sub-Table
+    TableParameters table_template;
+    table_template.annotations = params.annotations;
+    table_template.fallback_speed = params.fallback_speed;
+    table_template.fallback_coordinate_type = params.fallback_coordinate_type;
+    table_template.scale_factor = params.scale_factor;
+    table_template.exclude = params.exclude;
+    table_template.snapping = params.snapping;
+    table_template.generate_hints = false;
+    table_template.skip_waypoints = true;
+
+    pool.parallel_for(blocks.size(), [&](std::size_t b) {
+        const Group& block = blocks[b];
+        const std::vector<std::size_t>& sources = by_source ? block.keys : block.partners;
+        const std::vector<std::size_t>& destinations = by_source ? block.partners : block.keys;
+
+        TableParameters table = table_template;
+        for(std::size_t r = 0; r < sources.size(); ++r) {
+            append_coordinate(table, params, params.hints, sources[r]);
+            table.sources.push_back(r);
+        }
+        for(std::size_t c = 0; c < destinations.size(); ++c) {
+            append_coordinate(table, params, params.hints, destinations[c]);
+            table.destinations.push_back(sources.size() + c);
+        }
+
+        json::Object result;
+        check_status(engine.Table(table, result), result);
+
+        TableArrays cells;
+        cells.rows = sources.size();
+        cells.cols = destinations.size();
+        cells.has_durations = arrays.has_durations;
+        cells.has_distances = arrays.has_distances;
+        if(cells.has_durations) {
+            cells.durations.assign(cells.rows * cells.cols, std::numeric_limits<double>::quiet_NaN());
+        }
+        if(cells.has_distances) {
+            cells.distances.assign(cells.rows * cells.cols, std::numeric_limits<double>::quiet_NaN());
+        }
+        cells.fallback_speed_cells.assign(cells.rows * cells.cols, 0);
+        copy_table_block(result, cells, 0, 0);
+
+        // A pair whose partner is not in this sub-Table belongs to another chunk of a split group
+        std::unordered_map<std::size_t, std::size_t> partner_index;
+        for(std::size_t i = 0; i < block.partners.size(); ++i) {
+            partner_index.emplace(block.partners[i], i);
+        }
+        for(std::size_t k = 0; k < block.keys.size(); ++k) {
+            for(std::size_t p : pairs_of_key[block.keys[k]]) {
+                auto itr = partner_index.find(partner_of(pairs[p]));
+                if(itr == partner_index.end()) {
+                    continue;
+                }
+                const std::size_t cell = by_source ? k * cells.cols + itr->second : itr->second * cells.cols + k;
+                if(arrays.has_durations) {
+                    arrays.durations[p] = cells.durations[cell];
+                }
+                if(arrays.has_distances) {
+                    arrays.distances[p] = cells.distances[cell];
+                }
+                arrays.fallback_speed_cells[p] = cells.fallback_speed_cells[cell];
+            }
+        }
+    });
+
+    return arrays;
+}
+
+} //namespace osrm_nb_util
@@ -0,0 +1,142 @@
+#include "utility/param_key.h"
+
+#include "engine/approach.hpp"
+#include "engine/bearing.hpp"
+#include "engine/hint.hpp"
+#include "util/coordinate.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using osrm::engine::api::BaseParameters;
+using osrm::engine::api::MatchParameters;
+using osrm::engine::api::NearestParameters;
+using osrm::engine::api::RouteParameters;
+using osrm::engine::api::TableParameters;
+using osrm::engine::api::TripParameters;
+
+namespace {
+
+template<typename T>
+void put(std::string& key, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void put(std::string& key, const std::string& value) {
+    put(key, static_cast<std::uint64_t>(value.size()));
+    key.append(value);
+}
+
+void put(std::string& key, const osrm::util::Coordinate& coordinate) {
+    put(key, osrm::from_alias<std::int32_t>(coordinate.lon));
+    put(key, osrm::from_alias<std::int32_t>(coordinate.lat));
+}
+
+void put(std::string& key, const osrm::engine::Bearing& bearing) {
+    put(key, bearing.bearing);
+    put(key, bearing.range);
+}
+
+void put(std::string& key, const osrm::engine::Hint& hint) {
+    put(key, hint.ToBase64());
+}
+
+template<typename T>
+void put(std::string& key, const std::optional<T>& value) {
+    put(key, static_cast<std::uint8_t>(value.has_value()));
+    if(value) {
+        put(key, *value);
+    }
+}
+
+template<typename T>
+void put(std::string& key, const std::vector<T>& values) {
+    put(key, static_cast<std::uint64_t>(values.size()));
+    for(const auto& value : values) {
+        put(key, value);
+    }
+}
+
+void put_base(std::string& key, const BaseParameters& params) {
+    put(key, params.coordinates);
+    put(key, params.hints);
+    put(key, params.radiuses);
+    put(key, params.bearings);
+    put(key, params.approaches);
+
+    std::vector<std::string> exclude = params.exclude;
+    std::sort(exclude.begin(), exclude.end());
+    put(key, exclude);
+
+    put(key, static_cast<std::uint8_t>(params.format == BaseParameters::OutputFormatType::FLATBUFFERS));
+    put(key, params.generate_hints);
+    put(key, params.skip_waypoints);
+    put(key, params.snapping);
+}
+
+void put_route(std::string& key, const RouteParameters& params) {
+    put_base(key, params);
+    put(key, params.steps);
+    put(key, params.alternatives);
+    put(key, params.number_of_alternatives);
+    put(key, params.annotations);
+    put(key, params.annotations_type);
+    put(key, params.geometries);
+    put(key, params.overview);
+    put(key, params.continue_straight);
+    put(key, params.waypoints);
+}
+
+} //namespace
+
+namespace osrm_nb_util {
+
+std::string canonical_key(const MatchParameters& params) {
+    std::string key;
+    put_route(key, params);
+    put(key, params.timestamps);
+    put(key, params.gaps);
+    put(key, params.tidy);
+    return key;
+}
+
+std::string canonical_key(const NearestParameters& params) {
+    std::string key;
+    put_base(key, params);
+    put(key, params.number_of_results);
+    return key;
+}
+
+std::string canonical_key(const RouteParameters& params) {
+    std::string key;
+    put_route(key, params);
+    return key;
+}
+
+std::string canonical_key(const TableParameters& params) {
+    std::string key;
+    put_base(key, params);
+    put(key, params.sources);
+    put(key, params.destinations);
+    put(key, params.annotations);
+    put(key, params.fallback_speed);
+    put(key, params.fallback_coordinate_type);
+    put(key, params.scale_factor);
+    return key;
+}
+
+std::string canonical_key(const TripParameters& params) {
+    std::string key;
+    put_route(key, params);
+    put(key, params.source);
+    put(key, params.destination);
+    put(key, params.roundtrip);
+    return key;
+}
+
+} //namespace osrm_nb_util
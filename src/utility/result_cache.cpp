@@ -0,0 +1,41 @@
+#include "utility/result_cache.h"
+
+#include "util/json_container.hpp"
+
+#include <variant>
+
+namespace json = osrm::util::json;
+
+namespace osrm_nb_util {
+
+std::size_t approximate_size(const CachedResponse& response) {
+    return sizeof(CachedResponse) + approximate_size(response.json) + (response.flatbuffer ? response.flatbuffer->size() : 0);
+}
+
+std::size_t approximate_size(const json::Object& object) {
+    std::size_t size = sizeof(json::Object);
+    for(const auto& [key, child] : object.values) {
+        // Key, hash node and the value itself
+        size += key.capacity() + 2 * sizeof(void*) + approximate_size(child);
+    }
+    return size;
+}
+
+std::size_t approximate_size(const json::Value& value) {
+    std::size_t size = sizeof(json::Value);
+
+    if(const auto* str = std::get_if<json::String>(&value)) {
+        size += str->value.capacity();
+    }
+    else if(const auto* obj = std::get_if<json::Object>(&value)) {
+        size += approximate_size(*obj);
+    }
+    else if(const auto* arr = std::get_if<json::Array>(&value)) {
+        for(const auto& child : arr->values) {
+            size += approximate_size(child);
+        }
+    }
+    return size;
+}
+
+} //namespace osrm_nb_util
@@ -0,0 +1,223 @@
+#include "utility/service_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+unsigned highest_bit(std::uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<unsigned>(index);
+#else
+    return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#endif
+}
+
+using osrm_nb_util::Histogram;
+
+std::size_t bucket_index(std::uint64_t value) {
+    if(value < Histogram::sub_buckets) {
+        return static_cast<std::size_t>(value);
+    }
+    const unsigned shift = highest_bit(value) - Histogram::sub_bucket_bits;
+    return (shift + 1) * Histogram::sub_buckets + static_cast<std::size_t>((value >> shift) & (Histogram::sub_buckets - 1));
+}
+
+std::uint64_t bucket_upper(std::size_t index) {
+    if(index < Histogram::sub_buckets) {
+        return index;
+    }
+    const std::size_t shift = index / Histogram::sub_buckets - 1;
+    const std::uint64_t sub = Histogram::sub_buckets + index % Histogram::sub_buckets;
+    return ((sub + 1) << shift) - 1;
+}
+
+void atomic_max(std::atomic<std::uint64_t>& target, std::uint64_t value) {
+    std::uint64_t current = target.load(std::memory_order_relaxed);
+    while(current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+const char* prometheus_quantiles[] = { "0.5", "0.9", "0.99", "0.999" };
+const double quantile_values[] = { 0.5, 0.9, 0.99, 0.999 };
+
+} //namespace
+
+namespace osrm_nb_util {
+
+std::uint64_t Histogram::Snapshot::quantile(double q) const {
+    if(count == 0) {
+        return 0;
+    }
+
+    const auto rank = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(count)));
+    std::uint64_t seen = 0;
+    for(std::size_t i = 0; i < num_buckets; ++i) {
+        seen += buckets[i];
+        if(seen >= std::max<std::uint64_t>(rank, 1)) {
+            return std::min(bucket_upper(i), max);
+        }
+    }
+    return max;
+}
+
+void Histogram::record(std::uint64_t value) {
+    buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+    atomic_max(max, value);
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    // Not atomic as a whole, a concurrent record may show up in some fields only
+    Snapshot snap;
+    for(std::size_t i = 0; i < num_buckets; ++i) {
+        snap.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+        snap.count += snap.buckets[i];
+    }
+    snap.sum = sum.load(std::memory_order_relaxed);
+    snap.max = max.load(std::memory_order_relaxed);
+    return snap;
+}
+
+void Histogram::reset() {
+    for(auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+const char* phase_name(Phase phase) {
+    switch(phase) {
+        case Phase::Build: return "build";
+        case Phase::Validation: return "validation";
+        case Phase::Engine: return "engine";
+        case Phase::Conversion: return "conversion";
+        case Phase::ResponseSize: return "response_size";
+        default: return "unknown";
+    }
+}
+
+const char* service_name(StatsService service) {
+    switch(service) {
+        case StatsService::Match: return "match";
+        case StatsService::Nearest: return "nearest";
+        case StatsService::Route: return "route";
+        case StatsService::Table: return "table";
+        case StatsService::Trip: return "trip";
+        case StatsService::Tile: return "tile";
+        default: return "unknown";
+    }
+}
+
+void ServiceStats::count(const std::string& code) {
+    std::size_t index = status_codes.size() - 1;
+    for(std::size_t i = 0; i < status_codes.size(); ++i) {
+        if(code == status_codes[i]) {
+            index = i;
+            break;
+        }
+    }
+    codes[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+void ServiceStats::reset() {
+    for(auto& histogram : phases) {
+        histogram.reset();
+    }
+    for(auto& counter : codes) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
+
+void StatsRegistry::reset() {
+    for(auto& stats : services) {
+        stats.reset();
+    }
+    swap_durations.reset();
+    for(std::size_t s = 0; s < static_cast<std::size_t>(StatsService::Count); ++s) {
+        build_histogram(static_cast<StatsService>(s)).reset();
+    }
+}
+
+std::string StatsRegistry::prometheus() const {
+    std::ostringstream out;
+    out.precision(9);
+
+    out << "# HELP osrm_requests_total Requests by service and status code.\n"
+        << "# TYPE osrm_requests_total counter\n";
+    for(std::size_t s = 0; s < services.size(); ++s) {
+        const char* service = service_name(static_cast<StatsService>(s));
+        for(std::size_t c = 0; c < status_codes.size(); ++c) {
+            const std::uint64_t value = services[s].codes[c].load(std::memory_order_relaxed);
+            if(value > 0) {
+                out << "osrm_requests_total{service=\"" << service << "\",code=\"" << status_codes[c] << "\"} " << value << "\n";
+            }
+        }
+    }
+
+    auto summary = [&](const char* metric, const char* help, bool seconds, auto&& selected) {
+        out << "# HELP " << metric << " " << help << "\n"
+            << "# TYPE " << metric << " summary\n";
+        const double scale = seconds ? 1e-9 : 1.0;
+
+        for(std::size_t s = 0; s < services.size(); ++s) {
+            const auto service = static_cast<StatsService>(s);
+            for(std::size_t p = 0; p < static_cast<std::size_t>(Phase::Count); ++p) {
+                const auto phase = static_cast<Phase>(p);
+                if(!selected(phase)) {
+                    continue;
+                }
+                const Histogram& histogram = phase == Phase::Build ? build_histogram(service) : services[s].phases[p];
+                const Histogram::Snapshot snap = histogram.snapshot();
+                if(snap.count == 0) {
+                    continue;
+                }
+
+                std::string labels = std::string("service=\"") + service_name(service) + "\"";
+                if(seconds) {
+                    labels += std::string(",phase=\"") + phase_name(phase) + "\"";
+                }
+                for(std::size_t q = 0; q < 4; ++q) {
+                    out << metric << "{" << labels << ",quantile=\"" << prometheus_quantiles[q] << "\"} "
+                        << static_cast<double>(snap.quantile(quantile_values[q])) * scale << "\n";
+                }
+                out << metric << "_sum{" << labels << "} " << static_cast<double>(snap.sum) * scale << "\n";
+                out << metric << "_count{" << labels << "} " << snap.count << "\n";
+            }
+        }
+    };
+
+    summary("osrm_phase_seconds", "Time spent per request phase.", true,
+            [](Phase phase) { return phase != Phase::ResponseSize; });
+    summary("osrm_response_bytes", "Response size, approximate for JSON responses.", false,
+            [](Phase phase) { return phase == Phase::ResponseSize; });
+
+    const Histogram::Snapshot swaps = swap_durations.snapshot();
+    if(swaps.count > 0) {
+        out << "# HELP osrm_swap_seconds Time from the start of a dataset swap until the old engine drained.\n"
+            << "# TYPE osrm_swap_seconds summary\n";
+        for(std::size_t q = 0; q < 4; ++q) {
+            out << "osrm_swap_seconds{quantile=\"" << prometheus_quantiles[q] << "\"} "
+                << static_cast<double>(swaps.quantile(quantile_values[q])) * 1e-9 << "\n";
+        }
+        out << "osrm_swap_seconds_sum " << static_cast<double>(swaps.sum) * 1e-9 << "\n";
+        out << "osrm_swap_seconds_count " << swaps.count << "\n";
+    }
+
+    return out.str();
+}
+
+Histogram& build_histogram(StatsService service) {
+    static std::array<Histogram, static_cast<std::size_t>(StatsService::Count)> histograms;
+    return histograms[static_cast<std::size_t>(service)];
+}
+
+} //namespace osrm_nb_util
@@ -0,0 +1,113 @@
+#include "utility/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace osrm_nb_util {
+
+ThreadPool::ThreadPool(std::size_t num_threads) {
+    if(num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    workers.reserve(num_threads);
+    for(std::size_t i = 0; i < num_threads; ++i) {
+        workers.emplace_back([this] { worker_loop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+
+    for(auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    cv.notify_one();
+}
+
+void ThreadPool::worker_loop() {
+    while(true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+
+            if(stopping && tasks.empty()) {
+                return;
+            }
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallel_for(std::size_t n, const std::function<void(std::size_t)>& fn) {
+    if(n == 0) {
+        return;
+    }
+
+    struct State {
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> finished{0};
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    auto state = std::make_shared<State>();
+
+    // Helpers that only get scheduled after all indices were claimed exit without touching fn,
+    // and the calling thread works as well, so nested calls from a worker cannot deadlock.
+    auto run = [state, n, &fn] {
+        std::size_t i;
+        while((i = state->next.fetch_add(1)) < n) {
+            if(!state->failed) {
+                try {
+                    fn(i);
+                }
+                catch(...) {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if(!state->error) {
+                        state->error = std::current_exception();
+                    }
+                    state->failed = true;
+                }
+            }
+
+            if(state->finished.fetch_add(1) + 1 == n) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->done.notify_all();
+            }
+        }
+    };
+
+    const std::size_t helpers = std::min(workers.size(), n - 1);
+    for(std::size_t i = 0; i < helpers; ++i) {
+        submit(run);
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&state, n] { return state->finished == n; });
+
+    if(state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+} //namespace osrm_nb_util
@@ -0,0 +1,275 @@
+#include "utility/tile_pyramid.h"
+
+#include "osrm/status.hpp"
+#include "osrm/tile_parameters.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+using osrm::engine::api::TileParameters;
+
+namespace {
+
+constexpr char archive_magic[] = "OSRMTIL1";
+constexpr double max_latitude = 85.0511287798066;
+constexpr double pi = 3.14159265358979323846;
+
+struct TileId {
+    unsigned z;
+    unsigned x;
+    unsigned y;
+
+    bool operator<(const TileId& other) const {
+        return std::tie(z, x, y) < std::tie(other.z, other.x, other.y);
+    }
+};
+
+// Two independent 64-bit hashes and the size, so that distinct tiles never share a key in practice
+struct ContentKey {
+    std::uint64_t h1;
+    std::uint64_t h2;
+    std::size_t size;
+
+    bool operator==(const ContentKey& other) const {
+        return h1 == other.h1 && h2 == other.h2 && size == other.size;
+    }
+};
+
+struct ContentKeyHash {
+    std::size_t operator()(const ContentKey& key) const { return static_cast<std::size_t>(key.h1); }
+};
+
+ContentKey content_key(const std::string& data) {
+    std::uint64_t fnv = 0xcbf29ce484222325ull;
+    for(unsigned char c : data) {
+        fnv = (fnv ^ c) * 0x100000001b3ull;
+    }
+    return ContentKey{static_cast<std::uint64_t>(std::hash<std::string>{}(data)), fnv, data.size()};
+}
+
+unsigned lon_to_x(double lon, unsigned z) {
+    const double n = std::ldexp(1.0, static_cast<int>(z));
+    const double x = std::floor((lon + 180.0) / 360.0 * n);
+    return static_cast<unsigned>(std::clamp(x, 0.0, n - 1));
+}
+
+unsigned lat_to_y(double lat, unsigned z) {
+    const double n = std::ldexp(1.0, static_cast<int>(z));
+    const double rad = std::clamp(lat, -max_latitude, max_latitude) * pi / 180.0;
+    const double y = std::floor((1.0 - std::asinh(std::tan(rad)) / pi) / 2.0 * n);
+    return static_cast<unsigned>(std::clamp(y, 0.0, n - 1));
+}
+
+class TileStore {
+public:
+    virtual ~TileStore() = default;
+    // Stores a tile whose content was not seen before, called concurrently
+    virtual void put(const TileId& id, const std::string& data) = 0;
+    // Stores id as a copy of an earlier put(), called once every put() returned
+    virtual void put_duplicate(const TileId& id, const TileId& original) = 0;
+    virtual void finish() = 0;
+};
+
+class DirectoryStore : public TileStore {
+public:
+    explicit DirectoryStore(const std::string& path) : root(path) {}
+
+    void put(const TileId& id, const std::string& data) override {
+        const fs::path file = tile_path(id);
+        std::error_code ec;
+        fs::create_directories(file.parent_path(), ec);
+
+        std::ofstream out(file, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if(!out) {
+            throw std::runtime_error("Could not write " + file.string());
+        }
+    }
+
+    void put_duplicate(const TileId& id, const TileId& original) override {
+        const fs::path file = tile_path(id);
+        std::error_code ec;
+        fs::create_directories(file.parent_path(), ec);
+        fs::remove(file, ec);
+
+        // Fall back to a copy where hard links are not supported
+        fs::create_hard_link(tile_path(original), file, ec);
+        if(ec) {
+            fs::copy_file(tile_path(original), file, fs::copy_options::overwrite_existing);
+        }
+    }
+
+    void finish() override {}
+
+private:
+    fs::path tile_path(const TileId& id) const {
+        return root / std::to_string(id.z) / std::to_string(id.x) / (std::to_string(id.y) + ".mvt");
+    }
+
+    fs::path root;
+};
+
+class ArchiveStore : public TileStore {
+public:
+    explicit ArchiveStore(const std::string& path) : out(path, std::ios::binary | std::ios::trunc), path(path) {
+        if(!out) {
+            throw std::runtime_error("Could not create " + path);
+        }
+        out.write(archive_magic, 8);
+        offset = 8;
+    }
+
+    void put(const TileId& id, const std::string& data) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if(!out) {
+            throw std::runtime_error("Could not write " + path);
+        }
+        index.emplace_back(id, Blob{offset, static_cast<std::uint32_t>(data.size())});
+        blobs[id] = index.back().second;
+        offset += data.size();
+    }
+
+    void put_duplicate(const TileId& id, const TileId& original) override {
+        index.emplace_back(id, blobs.at(original));
+    }
+
+    void finish() override {
+        std::sort(index.begin(), index.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        const std::uint64_t index_offset = offset;
+        for(const auto& [id, blob] : index) {
+            put_le(static_cast<std::uint8_t>(id.z));
+            put_le(static_cast<std::uint32_t>(id.x));
+            put_le(static_cast<std::uint32_t>(id.y));
+            put_le(blob.offset);
+            put_le(blob.size);
+        }
+        put_le(index_offset);
+        put_le(static_cast<std::uint64_t>(index.size()));
+        out.write(archive_magic, 8);
+
+        out.close();
+        if(!out) {
+            throw std::runtime_error("Could not write " + path);
+        }
+    }
+
+private:
+    struct Blob {
+        std::uint64_t offset;
+        std::uint32_t size;
+    };
+
+    template<typename T>
+    void put_le(T value) {
+        char bytes[sizeof(T)];
+        for(std::size_t i = 0; i < sizeof(T); ++i) {
+            bytes[i] = static_cast<char>((static_cast<std::uint64_t>(value) >> (8 * i)) & 0xff);
+        }
+        out.write(bytes, sizeof(T));
+    }
+
+    std::ofstream out;
+    std::string path;
+    std::mutex mutex;
+    std::uint64_t offset = 0;
+    std::vector<std::pair<TileId, Blob>> index;
+    std::map<TileId, Blob> blobs;
+};
+
+} //namespace
+
+namespace osrm_nb_util {
+
+TilePyramidStats render_tile_pyramid(const osrm::OSRM& engine,
+                                     ThreadPool& pool,
+                                     double min_lon, double min_lat,
+                                     double max_lon, double max_lat,
+                                     unsigned min_zoom, unsigned max_zoom,
+                                     const std::string& path,
+                                     TileStoreFormat format)
+{
+    if(min_lon > max_lon || min_lat > max_lat) {
+        throw std::invalid_argument("bbox must be (min_lon, min_lat, max_lon, max_lat)");
+    }
+    if(min_zoom > max_zoom) {
+        throw std::invalid_argument("min_zoom must not be greater than max_zoom");
+    }
+
+    std::vector<TileId> tiles;
+    for(unsigned z = min_zoom; z <= max_zoom; ++z) {
+        if(!TileParameters{0, 0, z}.IsValid()) {
+            throw std::invalid_argument("Invalid zoom level " + std::to_string(z));
+        }
+        // Tile rows grow southwards
+        const unsigned x0 = lon_to_x(min_lon, z), x1 = lon_to_x(max_lon, z);
+        const unsigned y0 = lat_to_y(max_lat, z), y1 = lat_to_y(min_lat, z);
+        for(unsigned x = x0; x <= x1; ++x) {
+            for(unsigned y = y0; y <= y1; ++y) {
+                tiles.push_back(TileId{z, x, y});
+            }
+        }
+    }
+
+    std::unique_ptr<TileStore> store;
+    if(format == TileStoreFormat::Archive) {
+        store = std::make_unique<ArchiveStore>(path);
+    } else {
+        store = std::make_unique<DirectoryStore>(path);
+    }
+
+    std::mutex mutex;
+    std::unordered_map<ContentKey, TileId, ContentKeyHash> seen;
+    std::vector<std::pair<TileId, TileId>> duplicates;
+
+    TilePyramidStats stats;
+    stats.tiles = tiles.size();
+
+    pool.parallel_for(tiles.size(), [&](std::size_t i) {
+        const TileId& id = tiles[i];
+
+        std::string data;
+        if(engine.Tile(TileParameters{id.x, id.y, id.z}, data) != osrm::engine::Status::Ok) {
+            throw std::runtime_error("Could not render tile " + std::to_string(id.z) + "/" +
+                                     std::to_string(id.x) + "/" + std::to_string(id.y));
+        }
+
+        const ContentKey key = content_key(data);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto [itr, inserted] = seen.try_emplace(key, id);
+            if(!inserted) {
+                // Linked once every unique tile is written
+                duplicates.emplace_back(id, itr->second);
+                return;
+            }
+            stats.bytes += data.size();
+        }
+        store->put(id, data);
+    });
+
+    for(const auto& [id, original] : duplicates) {
+        store->put_duplicate(id, original);
+    }
+    store->finish();
+
+    stats.duplicates = duplicates.size();
+    stats.unique = stats.tiles - stats.duplicates;
+    return stats;
+}
+
+} //namespace osrm_nb_util
@@ -0,0 +1,162 @@
+#include "utility/tiled_table.h"
+
+#include "osrm/status.hpp"
+#include "engine/hint.hpp"
+#include "util/json_container.hpp"
+
+#include "utility/engine_utility.h"
+#include "utility/osrm_utility.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace json = osrm::util::json;
+using osrm::engine::api::TableParameters;
+
+namespace {
+
+std::vector<std::size_t> indices_or_all(const std::vector<std::size_t>& indices, std::size_t n) {
+    if(!indices.empty()) {
+        return indices;
+    }
+    std::vector<std::size_t> all(n);
+    std::iota(all.begin(), all.end(), 0);
+    return all;
+}
+
+} //namespace
+
+namespace osrm_nb_util {
+
+TiledTable run_tiled_table(const osrm::OSRM& engine,
+                           ThreadPool& pool,
+                           const TableParameters& params,
+                           std::size_t block_size,
+                           int max_locations)
+{
+    const std::size_t n = params.coordinates.size();
+    const std::vector<std::size_t> sources = indices_or_all(params.sources, n);
+    const std::vector<std::size_t> destinations = indices_or_all(params.destinations, n);
+
+    block_size = table_block_size(block_size, max_locations);
+
+    // Snap every coordinate in use once, the blocks only decode the hints
+    std::vector<std::size_t> used;
+    {
+        std::vector<char> in_use(n, 0);
+        for(std::size_t i : sources) in_use[i] = 1;
+        for(std::size_t i : destinations) in_use[i] = 1;
+        for(std::size_t i = 0; i < n; ++i) {
+            if(in_use[i]) used.push_back(i);
+        }
+    }
+
+    std::vector<std::optional<osrm::engine::Hint>> hints(n);
+    std::vector<json::Value> waypoints(n, json::Object());
+
+    // Snap the coordinates in chunks of block_size, each as the sources of a Table with the first of
+    // them as its only destination. Their waypoints carry every candidate segment, and the chunk stays
+    // within the engine's limit. A chunk of one coordinate repeats it, as a Table needs two coordinates.
+    const std::size_t snap_chunks = (used.size() + block_size - 1) / block_size;
+    pool.parallel_for(snap_chunks, [&](std::size_t k) {
+        const std::size_t first = k * block_size;
+        const std::size_t count = std::min(block_size, used.size() - first);
+
+        TableParameters snap;
+        snap.exclude = params.exclude;
+        snap.snapping = params.snapping;
+        for(std::size_t c = 0; c < std::max<std::size_t>(count, 2); ++c) {
+            append_coordinate(snap, params, params.hints, used[first + std::min(c, count - 1)]);
+        }
+        for(std::size_t c = 0; c < count; ++c) {
+            snap.sources.push_back(c);
+        }
+        snap.destinations = {0};
+
+        json::Object result;
+        const osrm::engine::Status status = engine.Table(snap, result);
+        if(status != osrm::engine::Status::Ok) {
+            throw std::runtime_error(status_code(status, result) + " - Could not snap coordinates " +
+                                     std::to_string(used[first]) + " to " + std::to_string(used[first + count - 1]));
+        }
+
+        auto& snapped = std::get<json::Array>(result.values["sources"]).values;
+        for(std::size_t c = 0; c < count; ++c) {
+            const std::size_t i = used[first + c];
+            auto& waypoint = std::get<json::Object>(snapped[c]);
+            auto hint = waypoint.values.find("hint");
+            if(hint != waypoint.values.end()) {
+                hints[i] = osrm::engine::Hint::FromBase64(std::get<json::String>(hint->second).value);
+            }
+            waypoints[i] = std::move(waypoint);
+        }
+    });
+
+    TiledTable table;
+    TableArrays& arrays = table.arrays;
+    arrays.rows = sources.size();
+    arrays.cols = destinations.size();
+    arrays.has_durations = has_annotation(params.annotations, TableParameters::AnnotationsType::Duration);
+    arrays.has_distances = has_annotation(params.annotations, TableParameters::AnnotationsType::Distance);
+    if(arrays.has_durations) {
+        arrays.durations.assign(arrays.rows * arrays.cols, std::numeric_limits<double>::quiet_NaN());
+    }
+    if(arrays.has_distances) {
+        arrays.distances.assign(arrays.rows * arrays.cols, std::numeric_limits<double>::quiet_NaN());
+    }
+    arrays.fallback_speed_cells.assign(arrays.rows * arrays.cols, 0);
+
+    // Shared options of every block, the per-coordinate vectors are filled per block
+    TableParameters block_template;
+    block_template.annotations = params.annotations;
+    block_template.fallback_speed = params.fallback_speed;
+    block_template.fallback_coordinate_type = params.fallback_coordinate_type;
+    block_template.scale_factor = params.scale_factor;
+    block_template.exclude = params.exclude;
+    block_template.snapping = params.snapping;
+    block_template.generate_hints = false;
+    block_template.skip_waypoints = true;
+
+    const std::size_t row_blocks = (arrays.rows + block_size - 1) / block_size;
+    const std::size_t col_blocks = (arrays.cols + block_size - 1) / block_size;
+
+    pool.parallel_for(row_blocks * col_blocks, [&](std::size_t k) {
+        const std::size_t row = (k / col_blocks) * block_size;
+        const std::size_t col = (k % col_blocks) * block_size;
+        const std::size_t num_rows = std::min(block_size, arrays.rows - row);
+        const std::size_t num_cols = std::min(block_size, arrays.cols - col);
+
+        TableParameters block = block_template;
+        for(std::size_t r = 0; r < num_rows; ++r) {
+            append_coordinate(block, params, hints, sources[row + r]);
+            block.sources.push_back(r);
+        }
+        for(std::size_t c = 0; c < num_cols; ++c) {
+            append_coordinate(block, params, hints, destinations[col + c]);
+            block.destinations.push_back(num_rows + c);
+        }
+
+        json::Object result;
+        check_status(engine.Table(block, result), result);
+        copy_table_block(result, arrays, row, col);
+    });
+
+    json::Array source_waypoints;
+    json::Array destination_waypoints;
+    source_waypoints.values.reserve(sources.size());
+    destination_waypoints.values.reserve(destinations.size());
+    for(std::size_t i : sources) source_waypoints.values.push_back(waypoints[i]);
+    for(std::size_t i : destinations) destination_waypoints.values.push_back(waypoints[i]);
+    table.waypoints.values["sources"] = std::move(source_waypoints);
+    table.waypoints.values["destinations"] = std::move(destination_waypoints);
+
+    return table;
+}
+
+} //namespace osrm_nb_util
@@ -0,0 +1,119 @@
+#include "utility/trip_bulk.h"
+
+#include "osrm/status.hpp"
+
+#include "utility/engine_utility.h"
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <tuple>
+#include <variant>
+
+namespace json = osrm::util::json;
+using osrm::engine::api::RouteParameters;
+using osrm::engine::api::TripParameters;
+
+namespace {
+
+double get_number(const json::Object& obj, const char* key) {
+    return std::get<json::Number>(obj.values.at(key)).value;
+}
+
+// Writes the visiting order and totals of a successful response, ordered by trip, then position
+void copy_solution(const json::Object& result, std::size_t k, osrm_nb_util::TripArrays& arrays) {
+    const auto& waypoints = std::get<json::Array>(result.values.at("waypoints")).values;
+    const auto& trips = std::get<json::Array>(result.values.at("trips")).values;
+
+    std::vector<std::tuple<std::size_t, std::size_t, std::int64_t>> order;
+    order.reserve(waypoints.size());
+    for(std::size_t i = 0; i < waypoints.size(); ++i) {
+        const auto& waypoint = std::get<json::Object>(waypoints[i]);
+        order.emplace_back(static_cast<std::size_t>(get_number(waypoint, "trips_index")),
+                           static_cast<std::size_t>(get_number(waypoint, "waypoint_index")),
+                           static_cast<std::int64_t>(i));
+    }
+    std::sort(order.begin(), order.end());
+
+    const auto begin = static_cast<std::size_t>(arrays.offsets[k]);
+    const auto end = static_cast<std::size_t>(arrays.offsets[k + 1]);
+    for(std::size_t j = 0; j < order.size() && begin + j < end; ++j) {
+        arrays.permutation[begin + j] = std::get<2>(order[j]);
+    }
+
+    double duration = 0;
+    double distance = 0;
+    for(const auto& trip : trips) {
+        duration += get_number(std::get<json::Object>(trip), "duration");
+        distance += get_number(std::get<json::Object>(trip), "distance");
+    }
+    arrays.duration[k] = duration;
+    arrays.distance[k] = distance;
+    arrays.num_trips[k] = static_cast<std::uint32_t>(trips.size());
+}
+
+} //namespace
+
+namespace osrm_nb_util {
+
+TripBulk run_trip_bulk(const osrm::OSRM& engine,
+                       ThreadPool& pool,
+                       std::vector<TripParameters>& params,
+                       bool keep_json,
+                       HintCache* hints)
+{
+    const std::size_t n = params.size();
+
+    TripBulk bulk;
+    TripArrays& arrays = bulk.arrays;
+    arrays.size = n;
+    arrays.offsets.resize(n + 1, 0);
+    for(std::size_t k = 0; k < n; ++k) {
+        arrays.offsets[k + 1] = arrays.offsets[k] + static_cast<std::int64_t>(params[k].coordinates.size());
+    }
+    arrays.permutation.assign(static_cast<std::size_t>(arrays.offsets[n]), -1);
+    arrays.duration.assign(n, std::numeric_limits<double>::quiet_NaN());
+    arrays.distance.assign(n, std::numeric_limits<double>::quiet_NaN());
+    arrays.num_trips.assign(n, 0);
+    bulk.codes.resize(n);
+    if(keep_json) {
+        bulk.results.resize(n);
+    }
+
+    pool.parallel_for(n, [&](std::size_t k) {
+        TripParameters& request = params[k];
+        if(!keep_json) {
+            request.overview = RouteParameters::OverviewType::False;
+            request.steps = false;
+            request.annotations = false;
+            request.annotations_type = RouteParameters::AnnotationsType::None;
+            // Hints are only needed to feed the snap cache
+            request.generate_hints = hints != nullptr;
+        }
+
+        json::Object local;
+        json::Object& result = keep_json ? bulk.results[k] : local;
+        if(!request.IsValid()) {
+            result = invalid_options_response(Service<TripParameters>::invalid_message);
+            bulk.codes[k] = "InvalidOptions";
+            return;
+        }
+
+        try {
+            const osrm::engine::Status status = run_with_hints(engine, request, result, hints);
+            bulk.codes[k] = status_code(status, result);
+            if(status == osrm::engine::Status::Ok) {
+                copy_solution(result, k, arrays);
+            }
+        }
+        catch(const std::exception& e) {
+            result = invalid_options_response(e.what());
+            result.values["code"] = json::String("Error");
+            bulk.codes[k] = "Error";
+        }
+    });
+
+    return bulk;
+}
+
+} //namespace osrm_nb_util
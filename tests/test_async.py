@@ -0,0 +1,71 @@
+import asyncio
+
+import pytest
+import osrm
+import constants
+
+data_path = constants.data_path
+three_test_coordinates = constants.three_test_coordinates
+two_test_coordinates = constants.two_test_coordinates
+
+class TestAsync:
+    py_osrm = osrm.OSRM(
+        storage_config = data_path,
+        use_shared_memory = False,
+        num_threads = 2,
+        max_in_flight = 2
+    )
+
+    def test_route_async(self):
+        route_params = osrm.RouteParameters(
+            coordinates = two_test_coordinates
+        )
+        expected = self.py_osrm.Route(route_params)
+
+        async def main():
+            return await self.py_osrm.RouteAsync(route_params)
+
+        res = asyncio.run(main())
+        assert(res == expected)
+
+    def test_gather(self):
+        route_params = osrm.RouteParameters(coordinates = three_test_coordinates)
+        table_params = osrm.TableParameters(coordinates = three_test_coordinates)
+        nearest_params = osrm.NearestParameters(coordinates = two_test_coordinates[0:1])
+
+        async def main():
+            # More requests than max_in_flight, the rest queue up for a free slot
+            routes = [self.py_osrm.RouteAsync(route_params) for _ in range(20)]
+            others = [
+                self.py_osrm.TableAsync(table_params, output = "bytes"),
+                self.py_osrm.NearestAsync(nearest_params, output = "object")
+            ]
+            return await asyncio.gather(*routes, *others)
+
+        *routes, table, nearest = asyncio.run(main())
+        assert(all(res == routes[0] for res in routes))
+        assert(isinstance(table, bytes))
+        assert(isinstance(nearest, osrm.Object))
+
+    def test_async_error(self):
+        route_params = osrm.RouteParameters(
+            coordinates = three_test_coordinates,
+            waypoints = [0]
+        )
+
+        async def main():
+            return await self.py_osrm.RouteAsync(route_params)
+
+        with pytest.raises(RuntimeError) as ex:
+            asyncio.run(main())
+        assert("InvalidValue" in str(ex.value))
+
+        # The instance can be used from a new event loop once the previous one is done
+        self.test_route_async()
+
+    def test_requires_running_loop(self):
+        route_params = osrm.RouteParameters(
+            coordinates = two_test_coordinates
+        )
+        with pytest.raises(RuntimeError):
+            self.py_osrm.RouteAsync(route_params)
@@ -1,3 +1,5 @@
+import asyncio
+
 import pytest
 import osrm
 import constants
@@ -101,3 +103,120 @@ class TestIndex:
                 default_radius = '10'
             )
         assert("Invalid type passed for argument" in str(ex.value))
+
+    def test_warmup(self):
+        py_osrm = osrm.OSRM(
+            storage_config = data_path,
+            use_shared_memory = False,
+            use_mmap = True
+        )
+        assert(py_osrm.LastWarmup() is None)
+
+        report = py_osrm.Warmup()
+        assert(report["files"] > 0 and report["bytes"] > 0)
+        assert(report["seconds"] >= 0)
+        assert(not report["huge_pages"] and not report["locked"])
+        assert(py_osrm.LastWarmup() == report)
+
+        py_osrm.Warmup(huge_pages = True, lock = True)
+
+        warm = osrm.OSRM(
+            storage_config = data_path,
+            use_shared_memory = False,
+            use_mmap = True,
+            warmup = True
+        )
+        assert(warm.LastWarmup()["bytes"] == report["bytes"])
+
+    def test_swap(self):
+        py_osrm = osrm.OSRM(
+            storage_config = data_path,
+            use_shared_memory = False,
+            cache_max_entries = 16
+        )
+        route_params = osrm.RouteParameters(coordinates = constants.two_test_coordinates)
+        expected = py_osrm.Route(route_params)["routes"]
+
+        # An open MatchSession keeps its engine alive, but the swap does not wait for it
+        session = py_osrm.MatchSession(window = 3, overlap = 1)
+        report = py_osrm.Swap(storage_config = data_path, warmup = True, drain_timeout = 5)
+        assert(report["drained"])
+        assert(report["drain_seconds"] < 5)
+        del session
+        assert(report["seconds"] >= report["build_seconds"])
+        assert(py_osrm.CacheStats()["entries"] == 0)
+        assert(py_osrm.LastWarmup()["bytes"] > 0)
+        assert(py_osrm.Route(route_params)["routes"] == expected)
+
+        with pytest.raises(RuntimeError):
+            py_osrm.Swap(storage_config = "missing.osrm")
+        with pytest.raises(ValueError):
+            py_osrm.Swap(drain_timeout = -1)
+        assert(py_osrm.Route(route_params)["routes"] == expected)
+        assert(py_osrm.Stats()["swap"]["count"] == 1)
+
+    def test_swap_in_flight(self):
+        py_osrm = osrm.OSRM(
+            storage_config = data_path,
+            use_shared_memory = False,
+            cache_max_entries = 16,
+            snap_cache_entries = 16
+        )
+        route_params = osrm.RouteParameters(coordinates = constants.two_test_coordinates)
+
+        # The request is pinned to the old engine when it is submitted and may cache its
+        # response before, during or after the swap, which does not wait for it
+        async def main():
+            future = py_osrm.RouteAsync(route_params)
+            report = py_osrm.Swap(storage_config = data_path, drain_timeout = 0)
+            return await future, report
+
+        res, report = asyncio.run(main())
+        assert(res["routes"])
+        assert(report["seconds"] >= report["build_seconds"])
+        assert(py_osrm.SnapCacheStats()["entries"] == 0)
+
+        # The response of the old dataset is never served for the new one
+        hits = py_osrm.CacheStats()["hits"]
+        misses = py_osrm.CacheStats()["misses"]
+        assert(py_osrm.Route(route_params)["routes"] == res["routes"])
+        assert(py_osrm.CacheStats()["hits"] == hits)
+        assert(py_osrm.CacheStats()["misses"] == misses + 1)
+        assert(py_osrm.SnapCacheStats()["hits"] == 0)
+        assert(py_osrm.Route(route_params)["routes"] == res["routes"])
+        assert(py_osrm.CacheStats()["hits"] == hits + 1)
+
+    def test_feature_preset(self):
+        py_osrm = osrm.OSRM(
+            storage_config = data_path,
+            use_shared_memory = False,
+            feature_preset = "table_only"
+        )
+        table_params = osrm.TableParameters(coordinates = constants.three_test_coordinates)
+        assert(py_osrm.Table(table_params)["code"] == "Ok")
+        with pytest.raises(RuntimeError) as ex:
+            py_osrm.Route(osrm.RouteParameters(coordinates = constants.two_test_coordinates, steps = True))
+        assert("DisabledDataset" in str(ex.value))
+
+        config = osrm.EngineConfig(
+            storage_config = data_path,
+            use_shared_memory = False,
+            disable_feature_dataset = ["ROUTE_STEPS"]
+        )
+        assert(config.disable_feature_dataset == ["ROUTE_STEPS"])
+
+        with pytest.raises(ValueError) as ex:
+            osrm.OSRM(storage_config = data_path, use_shared_memory = False, feature_preset = "route_only")
+        assert("Invalid Feature preset: 'route_only'" in str(ex.value))
+        with pytest.raises(ValueError):
+            osrm.OSRM(storage_config = data_path, use_shared_memory = False, disable_feature_dataset = ["ROUTE_NAMES"])
+
+    def test_compare_presets(self):
+        report = osrm.OSRM.ComparePresets(data_path)
+        assert(set(report) == {"full", "table_only", "nearest_only"})
+        assert(report["full"]["saved_bytes"] == 0 and report["full"]["disabled"] == [])
+        assert(report["table_only"]["disabled"] == ["ROUTE_STEPS", "ROUTE_GEOMETRY"])
+        assert(report["table_only"]["saved_bytes"] == report["full"]["resident_bytes"] - report["table_only"]["resident_bytes"])
+
+        with pytest.raises(ValueError):
+            osrm.OSRM.ComparePresets(data_path, presets = ["route_only"])
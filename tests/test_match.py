@@ -42,6 +42,28 @@ class TestMatch:
         assert(len(res["tracepoints"]) == 3)
         assert(len(res["matchings"]) == 1)
 
+    def test_match_session(self):
+        timestamps = [1424684612, 1424684616, 1424684620]
+        session = self.py_osrm.MatchSession(window = 3, overlap = 1)
+
+        res = session.Push(three_test_coordinates[:2], timestamps = timestamps[:2])
+        assert(len(res["tracepoints"]) == 0 and session.pending == 2)
+        res = session.Push(three_test_coordinates[2:], timestamps = timestamps[2:])
+        assert(len(res["tracepoints"]) == 2 and len(res["legs"]) == 1)
+        assert(res["legs"][0]["from"] == 0 and res["legs"][0]["to"] == 1)
+        assert(session.pending == 1)
+
+        rest = session.Finish()
+        assert(len(rest["tracepoints"]) == 1 and rest["tracepoints"][0]["index"] == 2)
+        assert(rest["legs"][0]["from"] == 1 and rest["legs"][0]["to"] == 2)
+        assert(rest["tracepoints"][0]["matchings_index"] == res["tracepoints"][0]["matchings_index"])
+        assert(session.pending == 0)
+
+        with pytest.raises(ValueError):
+            session.Push(three_test_coordinates, timestamps = timestamps[:1])
+        with pytest.raises(ValueError):
+            self.py_osrm.MatchSession(window = 3, overlap = 2)
+
     def test_match_no_geometrycompression(self):
         match_params = osrm.MatchParameters(
             coordinates = three_test_coordinates,
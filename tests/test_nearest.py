@@ -1,5 +1,6 @@
 import osrm
 import constants
+import pytest
 
 mld_data_path = constants.mld_data_path
 two_test_coordinates = constants.two_test_coordinates
@@ -18,3 +19,33 @@ class TestNearest:
         )
         res = self.py_osrm.Nearest(nearest_params)
         assert(len(res["waypoints"]) == 1)
+
+    def test_nearest_many(self):
+        params = [osrm.NearestParameters(coordinates = [c]) for c in constants.three_test_coordinates]
+        params.append(osrm.NearestParameters(coordinates = two_test_coordinates))
+        results, codes = self.py_osrm.NearestMany(params)
+        assert(codes == ["Ok", "Ok", "Ok", "InvalidOptions"])
+        for res in results[:3]:
+            assert(len(res["waypoints"]) == 1)
+
+    def test_nearest_bulk(self):
+        np = pytest.importorskip("numpy")
+        coordinates = np.array(constants.three_test_coordinates + [(float("nan"), 43.7)])
+
+        res = self.py_osrm.NearestBulk(coordinates)
+        assert(res["lon"].shape == (4,))
+        assert(res["nodes"].shape == (4, 2) and res["nodes"].dtype == np.uint64)
+        assert(list(res["status"]) == [0, 0, 0, 2])
+        assert(res["status_names"][res["status"][3]] == "InvalidValue")
+        assert(np.isnan(res["lon"][3]) and res["name"][3] == -1)
+
+        expected = self.py_osrm.Nearest(osrm.NearestParameters(coordinates = [constants.three_test_coordinates[0]]))
+        waypoint = expected["waypoints"][0]
+        assert(res["lon"][0] == pytest.approx(waypoint["location"][0]))
+        assert(res["distance"][0] == pytest.approx(waypoint["distance"]))
+        assert(res["names"][res["name"][0]] == waypoint["name"])
+        assert(list(res["nodes"][0]) == waypoint["nodes"])
+
+        top = self.py_osrm.NearestBulk(coordinates[:3], number_of_results = 3)
+        assert(top["distance"].shape == (3, 3))
+        assert(top["nodes"].shape == (3, 3, 2))
@@ -1,3 +1,5 @@
+import json
+
 import pytest
 import osrm
 import constants
@@ -315,3 +317,262 @@ class TestRoute:
         )
         res = self.py_osrm.Route(route_params)
         assert(round(res["routes"][0]["distance"] * 10) == 1315)
+
+    def test_route_many(self):
+        params = [
+            osrm.RouteParameters(coordinates = two_test_coordinates),
+            osrm.RouteParameters(coordinates = three_test_coordinates),
+            osrm.RouteParameters(coordinates = []),
+            osrm.RouteParameters(coordinates = three_test_coordinates, waypoints = [0])
+        ]
+        results, codes = self.py_osrm.RouteMany(params)
+        assert(codes == ["Ok", "Ok", "InvalidOptions", "InvalidValue"])
+        assert(len(results[0]["waypoints"]) == 2)
+        assert(len(results[1]["waypoints"]) == 3)
+        assert(results[2]["message"] == "Invalid Route Parameters")
+        assert(results[3]["code"] == "InvalidValue")
+
+        single = self.py_osrm.Route(params[1])
+        assert(results[1]["routes"][0]["distance"] == single["routes"][0]["distance"])
+
+    def test_route_many_error(self):
+        py_osrm = osrm.OSRM(
+            storage_config = data_path,
+            use_shared_memory = False,
+            disable_feature_dataset = ["ROUTE_STEPS"]
+        )
+        params = [
+            osrm.RouteParameters(coordinates = two_test_coordinates, steps = True),
+            osrm.RouteParameters(coordinates = two_test_coordinates)
+        ]
+        results, codes = py_osrm.RouteMany(params)
+        assert(codes == ["Error", "Ok"])
+        assert(results[0]["code"] == "Error")
+        assert("DisabledDataset" in results[0]["message"])
+        assert(results[1]["routes"])
+
+    def test_route_flatbuffers(self):
+        route_params = osrm.RouteParameters(
+            coordinates = two_test_coordinates,
+            format = "flatbuffers"
+        )
+        res = self.py_osrm.Route(route_params)
+        assert(isinstance(res, osrm.Buffer))
+        assert(len(res) > 0)
+
+        view = memoryview(res)
+        assert(view.readonly)
+        assert(view.nbytes == len(res))
+
+        route_params.format = osrm.OutputFormatType.JSON
+        res = self.py_osrm.Route(route_params)
+        assert(res["routes"])
+
+    def test_route_flatbuffers_error(self):
+        route_params = osrm.RouteParameters(
+            coordinates = three_test_coordinates,
+            waypoints = [0],
+            format = "flatbuffers"
+        )
+        with pytest.raises(RuntimeError) as ex:
+            self.py_osrm.Route(route_params)
+        assert("InvalidValue" in str(ex.value))
+
+    def test_route_lazy_object(self):
+        route_params = osrm.RouteParameters(
+            coordinates = two_test_coordinates,
+            steps = True
+        )
+        res = self.py_osrm.Route(route_params, output = "object")
+        expected = self.py_osrm.Route(route_params)
+        assert(isinstance(res, osrm.Object))
+        assert(isinstance(res["routes"], osrm.Array))
+        assert(isinstance(res["routes"][0], osrm.Object))
+        assert(res["routes"][0]["duration"] == expected["routes"][0]["duration"])
+        assert(res["routes"][-1]["distance"] == expected["routes"][0]["distance"])
+        assert("waypoints" in res)
+        assert(sorted(res.keys()) == sorted(expected.keys()))
+        assert(sorted(k for k, _ in res.items()) == sorted(expected.keys()))
+        assert(len(list(res["waypoints"])) == 2)
+        assert(res.to_dict() == expected)
+
+        # Proxies keep the response alive after the parent is gone
+        legs = res["routes"][0]["legs"]
+        del res
+        assert(len(legs) == 1)
+        assert(legs[0]["steps"])
+
+    def test_route_bytes(self):
+        route_params = osrm.RouteParameters(
+            coordinates = two_test_coordinates,
+            steps = True
+        )
+        res = self.py_osrm.Route(route_params, output = "bytes")
+        assert(isinstance(res, bytes))
+        expected = self.py_osrm.Route(route_params)
+        rendered = json.loads(res)
+        assert(rendered["code"] == "Ok")
+        assert(rendered["routes"][0]["duration"] == pytest.approx(expected["routes"][0]["duration"]))
+        assert(len(rendered["waypoints"]) == 2)
+
+    def test_route_params_equality(self):
+        a = osrm.RouteParameters(coordinates = two_test_coordinates, exclude = ["toll", "motorway"])
+        b = osrm.RouteParameters(coordinates = two_test_coordinates, exclude = ["motorway", "toll"])
+        c = osrm.RouteParameters(coordinates = two_test_coordinates, steps = True)
+        assert(a == b)
+        assert(a != c)
+        assert(a.cache_key() == b.cache_key())
+        assert(len({a.cache_key(), b.cache_key(), c.cache_key()}) == 2)
+
+        # Mutable, so not hashable, and never equal to another parameter type
+        with pytest.raises(TypeError):
+            hash(a)
+        match = osrm.MatchParameters(coordinates = two_test_coordinates, exclude = ["toll", "motorway"])
+        assert(a != match)
+        assert(match != a)
+
+    def test_route_template(self):
+        template = osrm.RouteParameters(steps = True, overview = "false")
+        expected = self.py_osrm.Route(osrm.RouteParameters(coordinates = two_test_coordinates, steps = True, overview = "false"))
+
+        res = self.py_osrm.Route(template, coordinates = two_test_coordinates)
+        assert(res == expected)
+
+        hints = [waypoint["hint"] for waypoint in res["waypoints"]]
+        res = self.py_osrm.Route(template, coordinates = two_test_coordinates, hints = hints, radiuses = [None, 100])
+        assert(res["routes"][0]["legs"][0]["steps"])
+
+        with pytest.raises(ValueError):
+            self.py_osrm.Route(template, coordinates = two_test_coordinates, hints = ["abc", None])
+        with pytest.raises(RuntimeError):
+            self.py_osrm.Route(template)
+
+    def test_route_numpy(self):
+        np = pytest.importorskip("numpy")
+        route_params = osrm.RouteParameters(
+            coordinates = three_test_coordinates,
+            annotations = ["duration", "nodes"]
+        )
+        expected = self.py_osrm.Route(osrm.RouteParameters(
+            coordinates = three_test_coordinates,
+            annotations = ["duration", "nodes"],
+            geometries = "geojson",
+            overview = "full"
+        ))["routes"][0]
+
+        res = self.py_osrm.Route(route_params, output = "numpy")
+        assert(res["code"] == "Ok")
+        assert(res["waypoints"]["location"].shape == (3, 2))
+        route = res["routes"][0]
+        assert(route["duration"] == pytest.approx(expected["duration"]))
+
+        geometry = route["geometry"]
+        assert(geometry.dtype == np.float64)
+        assert(np.allclose(geometry, expected["geometry"]["coordinates"]))
+
+        offsets = route["leg_offsets"]
+        assert(offsets.tolist()[0] == 0 and offsets[-1] == len(geometry) - 1)
+        assert(len(offsets) == len(expected["legs"]) + 1)
+
+        annotations = route["annotations"]
+        assert(set(annotations) == {"duration", "nodes", "node_offsets"})
+        assert(annotations["nodes"].dtype == np.uint64)
+        for k, leg in enumerate(expected["legs"]):
+            durations = annotations["duration"][offsets[k]:offsets[k + 1]]
+            assert(np.allclose(durations, leg["annotation"]["duration"]))
+            nodes = annotations["nodes"][annotations["node_offsets"][k]:annotations["node_offsets"][k + 1]]
+            assert(nodes.tolist() == leg["annotation"]["nodes"])
+
+    def test_route_cache(self):
+        py_osrm = osrm.OSRM(
+            storage_config = data_path,
+            use_shared_memory = False,
+            cache_max_entries = 1
+        )
+        route_params = osrm.RouteParameters(coordinates = two_test_coordinates)
+        other_params = osrm.RouteParameters(coordinates = three_test_coordinates)
+
+        expected = py_osrm.Route(route_params)
+        assert(py_osrm.Route(route_params) == expected)
+        assert(py_osrm.Route(route_params, output = "object").to_dict() == expected)
+        stats = py_osrm.CacheStats()
+        assert(stats["enabled"])
+        assert((stats["hits"], stats["misses"], stats["entries"]) == (2, 1, 1))
+
+        py_osrm.Route(other_params)
+        assert(py_osrm.CacheStats()["evictions"] == 1)
+
+        py_osrm.ClearCache()
+        assert(py_osrm.CacheStats()["entries"] == 0)
+        assert(not self.py_osrm.CacheStats()["enabled"])
+
+    def test_route_snap_cache(self):
+        py_osrm = osrm.OSRM(
+            storage_config = data_path,
+            use_shared_memory = False,
+            snap_cache_entries = 16
+        )
+        route_params = osrm.RouteParameters(coordinates = two_test_coordinates)
+
+        expected = py_osrm.Route(route_params)
+        assert(py_osrm.SnapCacheStats()["entries"] == 2)
+        assert(py_osrm.Route(route_params) == expected)
+        stats = py_osrm.SnapCacheStats()
+        assert((stats["hits"], stats["misses"]) == (2, 2))
+
+        no_hints = osrm.RouteParameters(coordinates = three_test_coordinates, generate_hints = False)
+        py_osrm.Route(no_hints)
+        assert(py_osrm.SnapCacheStats()["entries"] == 2)
+
+        py_osrm.ClearSnapCache()
+        assert(py_osrm.SnapCacheStats()["entries"] == 0)
+        assert(not self.py_osrm.SnapCacheStats()["enabled"])
+
+    def test_route_flatbuffers_caches(self):
+        py_osrm = osrm.OSRM(
+            storage_config = data_path,
+            use_shared_memory = False,
+            cache_max_entries = 4,
+            snap_cache_entries = 16
+        )
+        route_params = osrm.RouteParameters(coordinates = two_test_coordinates, format = "flatbuffers")
+
+        # The flatbuffers response warms the snap cache and is cached apart from the JSON one
+        expected = bytes(py_osrm.Route(route_params))
+        assert(py_osrm.SnapCacheStats()["entries"] == 2)
+        assert(bytes(py_osrm.Route(route_params)) == expected)
+        stats = py_osrm.CacheStats()
+        assert((stats["hits"], stats["misses"], stats["entries"]) == (1, 1, 1))
+
+        route_params.format = osrm.OutputFormatType.JSON
+        assert(py_osrm.Route(route_params)["routes"])
+        assert(py_osrm.CacheStats()["entries"] == 2)
+
+    def test_route_stats(self):
+        py_osrm = osrm.OSRM(
+            storage_config = data_path,
+            use_shared_memory = False
+        )
+        route_params = osrm.RouteParameters(coordinates = two_test_coordinates)
+
+        py_osrm.Route(route_params)
+        py_osrm.Route(route_params, output = "bytes")
+        with pytest.raises(RuntimeError):
+            py_osrm.Route(osrm.RouteParameters())
+
+        stats = py_osrm.Stats()["route"]
+        assert(stats["requests"] == 3)
+        assert(stats["codes"] == {"Ok": 2, "InvalidOptions": 1})
+        assert(stats["validation"]["count"] == 3)
+        assert(stats["engine"]["count"] == 2)
+        assert(stats["conversion"]["count"] == 2)
+        assert(stats["response_size"]["p50"] > 0)
+        assert(stats["build"]["count"] >= 1)
+        assert(0 < stats["engine"]["p50"] <= stats["engine"]["max"])
+
+        text = py_osrm.StatsPrometheus()
+        assert('osrm_requests_total{service="route",code="Ok"} 2' in text)
+        assert('osrm_phase_seconds_count{service="route",phase="engine"} 2' in text)
+
+        py_osrm.ResetStats()
+        assert(py_osrm.Stats()["route"]["requests"] == 0)
@@ -0,0 +1,59 @@
+import pytest
+import osrm
+import constants
+
+data_path = constants.data_path
+mld_data_path = constants.mld_data_path
+two_test_coordinates = constants.two_test_coordinates
+
+class TestRouter:
+    router = osrm.Router(
+        {
+            "car": data_path,
+            "foot": {"storage_config": mld_data_path, "algorithm": "MLD"},
+        },
+        use_shared_memory = False,
+        cache_max_entries = 64
+    )
+
+    def test_router_profiles(self):
+        assert(self.router.Profiles() == ["car", "foot"])
+        assert("car" in self.router and "bike" not in self.router)
+        assert(len(self.router) == 2)
+
+        with pytest.raises(KeyError):
+            self.router["bike"]
+        with pytest.raises(ValueError):
+            osrm.Router({})
+
+    def test_router_dispatch(self):
+        route_params = osrm.RouteParameters(coordinates = two_test_coordinates)
+        car = osrm.OSRM(storage_config = data_path, use_shared_memory = False)
+        foot = osrm.OSRM(storage_config = mld_data_path, algorithm = "MLD", use_shared_memory = False)
+
+        assert(self.router.Route("car", route_params)["routes"] == car.Route(route_params)["routes"])
+        assert(self.router.Route("foot", route_params)["routes"] == foot.Route(route_params)["routes"])
+        assert(self.router["car"].Route(route_params)["routes"] == car.Route(route_params)["routes"])
+        with pytest.raises(KeyError):
+            self.router.Route("bike", route_params)
+
+    def test_router_stats(self):
+        router = osrm.Router({"car": data_path, "foot": data_path}, use_shared_memory = False, cache_max_entries = 64)
+        table_params = osrm.TableParameters(coordinates = two_test_coordinates)
+
+        router.Table("car", table_params)
+        router.Table("car", table_params)
+        router.Table("foot", table_params)
+
+        stats = router.Stats()
+        assert(stats["car"]["table"]["requests"] == 2)
+        assert(stats["foot"]["table"]["requests"] == 1)
+        assert(stats["car"]["memory"]["dataset_bytes"] > 0)
+        # Both profiles cache their own response in the shared budget
+        assert(stats["car"]["memory"]["cache_entries"] == 1)
+        assert(stats["foot"]["memory"]["cache_entries"] == 1)
+        assert(router["car"].CacheStats()["hits"] == 1)
+
+        router["car"].ClearCache()
+        assert(router.Stats()["car"]["memory"]["cache_entries"] == 0)
+        assert(router.Stats()["foot"]["memory"]["cache_entries"] == 1)
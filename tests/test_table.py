@@ -154,3 +154,157 @@ class TestTable:
 
         table_params.scale_factor = 1
         res = py_osrm.Table(table_params)
+
+    def test_table_many(self):
+        params = [
+            osrm.TableParameters(coordinates = two_test_coordinates),
+            osrm.TableParameters(coordinates = three_test_coordinates, sources = [0]),
+            osrm.TableParameters(coordinates = two_test_coordinates, scale_factor = -1)
+        ]
+        results, codes = self.py_osrm.TableMany(params)
+        assert(codes == ["Ok", "Ok", "InvalidOptions"])
+        assert(len(results[0]["durations"]) == 2)
+        assert(len(results[1]["durations"]) == 1)
+        assert(len(results[1]["durations"][0]) == 3)
+
+    def test_table_numpy(self):
+        np = pytest.importorskip("numpy")
+        table_params = osrm.TableParameters(
+            coordinates = three_test_coordinates,
+            sources = [0, 1],
+            annotations = ["duration", "distance"]
+        )
+        res = self.py_osrm.Table(table_params, output = "numpy")
+        expected = self.py_osrm.Table(table_params)
+
+        assert(res["durations"].shape == (2, 3))
+        assert(res["durations"].dtype == np.float64)
+        assert(res["durations"].flags["C_CONTIGUOUS"])
+        assert(np.allclose(res["durations"], np.array(expected["durations"], dtype = float)))
+        assert(np.allclose(res["distances"], np.array(expected["distances"], dtype = float)))
+        assert(res["fallback_speed_cells"].dtype == np.bool_)
+        assert(not res["fallback_speed_cells"].any())
+        assert(res["sources"]["location"].shape == (2, 2))
+        assert(res["destinations"]["location"].shape == (3, 2))
+        assert(len(res["destinations"]["name"]) == 3)
+
+        with pytest.raises(ValueError):
+            self.py_osrm.Table(table_params, output = "arrow")
+
+    def test_table_numpy_params(self):
+        np = pytest.importorskip("numpy")
+        expected = self.py_osrm.Table(osrm.TableParameters(
+            coordinates = three_test_coordinates,
+            sources = [0, 1],
+            destinations = [2]
+        ))
+
+        coordinates = np.array(three_test_coordinates, dtype = np.float64)
+        table_params = osrm.TableParameters(
+            coordinates = coordinates,
+            sources = np.array([0, 1], dtype = np.uint32),
+            destinations = np.array([2], dtype = np.uint64),
+            radiuses = np.array([np.nan, 100.0, np.nan]),
+            bearings = np.array([[-1, 0], [-1, 0], [-1, 0]], dtype = np.int16)
+        )
+        assert(table_params.radiuses == [None, 100.0, None])
+        assert(table_params.bearings == [None, None, None])
+        res = self.py_osrm.Table(table_params)
+        assert(res["durations"] == expected["durations"])
+
+        # int32 coordinates are fixed-point, degrees * 1e6
+        table_params.coordinates = np.round(coordinates * 1e6).astype(np.int32)
+        table_params.radiuses = []
+        table_params.bearings = []
+        res = self.py_osrm.Table(table_params)
+        assert(res["durations"] == expected["durations"])
+
+        # Non-contiguous int32 arrays are still fixed-point
+        fixed = np.round(coordinates[:, ::-1] * 1e6).astype(np.int32)[:, ::-1]
+        assert(not fixed.flags["C_CONTIGUOUS"])
+        table_params.coordinates = fixed
+        assert(self.py_osrm.Table(table_params)["durations"] == expected["durations"])
+        table_params.coordinates = np.asfortranarray(fixed)
+        assert(self.py_osrm.Table(table_params)["durations"] == expected["durations"])
+
+        with pytest.raises(ValueError):
+            table_params.coordinates = np.zeros((3, 3))
+        with pytest.raises(ValueError):
+            table_params.coordinates = fixed.astype(np.int64)
+        with pytest.raises(ValueError):
+            table_params.sources = np.array([-1])
+
+        # Other bearing dtypes are checked instead of truncated
+        table_params.bearings = np.array([[np.nan, 0], [90, 10], [-1, 0]])
+        assert(table_params.bearings[0] is None and table_params.bearings[2] is None)
+        with pytest.raises(ValueError):
+            table_params.bearings = np.array([[90.5, 10], [90, 10], [90, 10]])
+        with pytest.raises(ValueError):
+            table_params.bearings = np.array([[40000, 10], [90, 10], [90, 10]], dtype = np.int32)
+
+        match_params = osrm.MatchParameters(coordinates = three_test_coordinates)
+        with pytest.raises(ValueError):
+            match_params.timestamps = np.array([0, 1, 2 ** 32], dtype = np.int64)
+
+    def test_table_tiled(self):
+        np = pytest.importorskip("numpy")
+        table_params = osrm.TableParameters(
+            coordinates = three_test_coordinates,
+            sources = [0, 2],
+            annotations = ["duration", "distance"]
+        )
+        expected = self.py_osrm.Table(table_params, output = "numpy")
+
+        res = self.py_osrm.TableTiled(table_params, block_size = 1)
+        assert(res["durations"].shape == (2, 3))
+        assert(np.allclose(res["durations"], expected["durations"], equal_nan = True))
+        assert(np.allclose(res["distances"], expected["distances"], equal_nan = True))
+        assert(np.allclose(res["sources"]["location"], expected["sources"]["location"]))
+        assert(res["destinations"]["name"] == expected["destinations"]["name"])
+
+        # Larger than the engine's limit, the blocks are sized to fit it
+        py_osrm = osrm.OSRM(
+            storage_config = data_path,
+            use_shared_memory = False,
+            max_locations_distance_table = 2
+        )
+        with pytest.raises(RuntimeError):
+            py_osrm.Table(table_params)
+        res = py_osrm.TableTiled(table_params)
+        assert(np.allclose(res["durations"], expected["durations"], equal_nan = True))
+
+    def test_table_pairs(self):
+        np = pytest.importorskip("numpy")
+        table_params = osrm.TableParameters(
+            coordinates = three_test_coordinates,
+            annotations = ["duration", "distance"]
+        )
+        expected = self.py_osrm.Table(table_params, output = "numpy")
+
+        pairs = [(0, 1), (0, 2), (2, 1), (1, 1), (0, 1)]
+        res = self.py_osrm.TablePairs(table_params, pairs = pairs, block_size = 1)
+        assert(res["durations"].shape == (len(pairs),))
+        assert(res["sub_tables"] >= 1)
+        for i, (source, destination) in enumerate(pairs):
+            assert(np.isclose(res["durations"][i], expected["durations"][source, destination], equal_nan = True))
+            assert(np.isclose(res["distances"][i], expected["distances"][source, destination], equal_nan = True))
+
+        res = self.py_osrm.TablePairs(table_params, pairs = np.array(pairs))
+        assert(np.allclose(res["durations"], [expected["durations"][s, d] for s, d in pairs], equal_nan = True))
+
+        # Coordinates repeated across origins and destinations are snapped once
+        res = self.py_osrm.TablePairs(
+            table_params,
+            origins = [three_test_coordinates[s] for s, _ in pairs],
+            destinations = [three_test_coordinates[d] for _, d in pairs]
+        )
+        assert(np.allclose(res["durations"], [expected["durations"][s, d] for s, d in pairs], equal_nan = True))
+
+        with pytest.raises(ValueError):
+            self.py_osrm.TablePairs(table_params)
+        with pytest.raises(ValueError):
+            self.py_osrm.TablePairs(table_params, pairs = pairs, origins = three_test_coordinates)
+        with pytest.raises(ValueError):
+            self.py_osrm.TablePairs(table_params, origins = three_test_coordinates, destinations = three_test_coordinates[:2])
+        with pytest.raises(ValueError):
+            self.py_osrm.TablePairs(table_params, pairs = [(0, 3)])
@@ -0,0 +1,146 @@
+import asyncio
+import os
+import sys
+import sysconfig
+from concurrent.futures import ThreadPoolExecutor
+
+import pytest
+import osrm
+import constants
+
+data_path = constants.data_path
+mld_data_path = constants.mld_data_path
+three_test_coordinates = constants.three_test_coordinates
+
+num_workers = min(4, os.cpu_count() or 1)
+num_requests = 400
+
+# A free-threaded interpreter that still runs without the GIL after importing osrm
+free_threaded = bool(sysconfig.get_config_var("Py_GIL_DISABLED"))
+gil_disabled = free_threaded and not sys._is_gil_enabled()
+
+def run_threaded(py_osrm, params):
+    def worker(n):
+        return [py_osrm.Route(params) for _ in range(n)]
+
+    with ThreadPoolExecutor(max_workers = num_workers) as pool:
+        futures = [pool.submit(worker, num_requests // num_workers) for _ in range(num_workers)]
+        return [res for f in futures for res in f.result()]
+
+class TestThreading:
+    # Scaling with the number of threads is measured by benchmarks/bench.py, here only the results are checked
+    @pytest.mark.parametrize("algorithm,storage_config", [("CH", data_path), ("MLD", mld_data_path)])
+    def test_route_concurrent(self, algorithm, storage_config):
+        py_osrm = osrm.OSRM(
+            algorithm = algorithm,
+            storage_config = storage_config,
+            use_shared_memory = False
+        )
+        route_params = osrm.RouteParameters(
+            coordinates = three_test_coordinates,
+            overview = "full",
+            steps = True
+        )
+        expected = py_osrm.Route(route_params)
+
+        results = run_threaded(py_osrm, route_params)
+        assert(len(results) == num_workers * (num_requests // num_workers))
+        for res in results:
+            assert(res == expected)
+
+    def test_concurrent_param_mutation(self):
+        py_osrm = osrm.OSRM(
+            storage_config = data_path,
+            use_shared_memory = False
+        )
+        route_params = osrm.RouteParameters(
+            coordinates = three_test_coordinates
+        )
+
+        def mutate():
+            for i in range(num_requests):
+                route_params.coordinates = three_test_coordinates[0:2 + i % 2]
+
+        def query():
+            for _ in range(num_requests):
+                res = py_osrm.Route(route_params)
+                assert(len(res["waypoints"]) in (2, 3))
+
+        with ThreadPoolExecutor(max_workers = 2) as pool:
+            futures = [pool.submit(mutate), pool.submit(query)]
+            for f in futures:
+                f.result()
+
+    def test_swap_under_load(self):
+        py_osrm = osrm.OSRM(
+            storage_config = data_path,
+            use_shared_memory = False,
+            cache_max_entries = 16
+        )
+        route_params = osrm.RouteParameters(
+            coordinates = three_test_coordinates
+        )
+        expected = py_osrm.Route(route_params)["routes"]
+
+        def query():
+            for _ in range(num_requests):
+                assert(py_osrm.Route(route_params)["routes"] == expected)
+
+        with ThreadPoolExecutor(max_workers = num_workers + 1) as pool:
+            futures = [pool.submit(query) for _ in range(num_workers)]
+            reports = [pool.submit(py_osrm.Swap, storage_config = data_path).result() for _ in range(3)]
+            for f in futures:
+                f.result()
+
+        assert(all(report["drained"] for report in reports))
+        assert(py_osrm.Stats()["swap"]["count"] == 3)
+
+    @pytest.mark.skipif(not free_threaded, reason = "Requires a free-threaded interpreter")
+    def test_module_gil_free(self):
+        # Importing an extension that is not declared GIL-free turns the GIL back on
+        assert(not sys._is_gil_enabled() or os.environ.get("PYTHON_GIL") == "1")
+
+    @pytest.mark.skipif(not gil_disabled, reason = "Requires a free-threaded interpreter running without the GIL")
+    def test_free_threaded_stress(self):
+        py_osrm = osrm.OSRM(
+            storage_config = data_path,
+            use_shared_memory = False,
+            cache_max_entries = 64,
+            snap_cache_entries = 64
+        )
+        route_params = osrm.RouteParameters(
+            coordinates = three_test_coordinates
+        )
+        table_params = osrm.TableParameters(
+            coordinates = three_test_coordinates
+        )
+        expected = py_osrm.Table(table_params)["durations"]
+
+        def mutate():
+            for i in range(num_requests):
+                route_params.coordinates = three_test_coordinates[0:2 + i % 2]
+                route_params.steps = i % 2 == 0
+
+        def query():
+            for _ in range(num_requests):
+                assert(len(py_osrm.Route(route_params)["waypoints"]) in (2, 3))
+                assert(py_osrm.Table(table_params)["durations"] == expected)
+                py_osrm.Nearest(osrm.NearestParameters(coordinates = three_test_coordinates[0:1]))
+
+        def query_async():
+            async def main():
+                return await asyncio.gather(*[py_osrm.TableAsync(table_params) for _ in range(num_requests // 10)])
+            for _ in range(5):
+                assert(all(res["durations"] == expected for res in asyncio.run(main())))
+
+        def stats():
+            for _ in range(num_requests // 10):
+                py_osrm.Stats()
+
+        threads = [mutate, stats, query_async] + [query] * (2 * num_workers)
+        with ThreadPoolExecutor(max_workers = len(threads)) as pool:
+            futures = [pool.submit(thread) for thread in threads]
+            for f in futures:
+                f.result()
+
+        assert(py_osrm.Stats()["table"]["requests"] > 2 * num_workers * num_requests)
@@ -1,4 +1,5 @@
 import pytest
+import struct
 import osrm
 import constants
 
@@ -26,3 +27,33 @@ class TestTile:
             tile_params = osrm.TileParameters([17059, 11948, -15])
         tile_params = osrm.TileParameters([17059, 11948, 15])
         res = self.py_osrm.Tile(tile_params)
+
+    def test_tile_buffer(self):
+        res = self.py_osrm.Tile(osrm.TileParameters(test_tile["at"]))
+        assert(isinstance(res, osrm.Buffer))
+        view = memoryview(res)
+        assert(view.readonly and view.nbytes == test_tile["size"])
+        assert(bytes(res) == view.tobytes())
+
+    def test_render_tiles(self, tmp_path):
+        bbox = (7.40, 43.72, 7.44, 43.75)
+
+        stats = self.py_osrm.RenderTiles(bbox, 14, 15, str(tmp_path / "tiles"))
+        assert(stats["tiles"] == stats["unique"] + stats["duplicates"])
+        files = list((tmp_path / "tiles").rglob("*.mvt"))
+        assert(len(files) == stats["tiles"])
+        expected = bytes(self.py_osrm.Tile(osrm.TileParameters(test_tile["at"])))
+        assert((tmp_path / "tiles" / "15" / "17059" / "11948.mvt").read_bytes() == expected)
+
+        archive = tmp_path / "tiles.bin"
+        assert(self.py_osrm.RenderTiles(bbox, 14, 15, str(archive), format = "archive") == stats)
+        data = archive.read_bytes()
+        assert(data[:8] == data[-8:] == b"OSRMTIL1")
+        index_offset, count = struct.unpack("<QQ", data[-24:-8])
+        assert(count == stats["tiles"])
+        entries = [struct.unpack_from("<BIIQI", data, index_offset + i * 21) for i in range(count)]
+        tile = next(e for e in entries if e[:3] == (15, 17059, 11948))
+        assert(data[tile[3]:tile[3] + tile[4]] == expected)
+
+        with pytest.raises(ValueError):
+            self.py_osrm.RenderTiles(bbox, 5, 6, str(tmp_path / "low"))
@@ -1,3 +1,4 @@
+import pytest
 import osrm
 import constants
 
@@ -134,3 +135,25 @@ class TestTrip:
         res = py_osrm.Trip(trip_params)
         assert(len(res["waypoints"]) == 2)
         assert(len(res["trips"]) == 1)
+
+    def test_trip_bulk(self):
+        np = pytest.importorskip("numpy")
+        params = [osrm.TripParameters(coordinates = three_test_coordinates),
+                  osrm.TripParameters(coordinates = two_test_coordinates)]
+        expected = self.py_osrm.Trip(params[0])
+
+        res = self.py_osrm.TripBulk(params)
+        assert(list(res["offsets"]) == [0, 3, 5])
+        assert(res["codes"] == ["Ok", "Ok"] and res["responses"] is None)
+        assert(res["duration"][0] == pytest.approx(expected["trips"][0]["duration"]))
+        order = sorted(range(3), key = lambda i: expected["waypoints"][i]["waypoint_index"])
+        assert(list(res["permutation"][:3]) == order)
+
+        coordinates = np.array(three_test_coordinates + two_test_coordinates)
+        ragged = self.py_osrm.TripBulk(coordinates, offsets = [0, 3, 5], full_json = True)
+        assert(np.array_equal(ragged["permutation"], res["permutation"]))
+        assert(ragged["responses"][0]["trips"][0]["geometry"])
+
+        failed = self.py_osrm.TripBulk(coordinates[:1], offsets = [0, 1], trip_params = osrm.TripParameters(roundtrip = False))
+        assert(failed["codes"][0] != "Ok" and np.isnan(failed["duration"][0]))
+        assert(list(failed["permutation"]) == [-1])